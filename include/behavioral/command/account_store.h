@@ -0,0 +1,112 @@
+#ifndef INCLUDE_BEHAVIORAL_COMMAND_ACCOUNT_STORE_H
+#define INCLUDE_BEHAVIORAL_COMMAND_ACCOUNT_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "behavioral/command/command.h"
+
+namespace DesignPatterns::Command
+{
+
+// 余额在内存中的排列
+enum class AccountLayout {
+  Packed,  // 每个缓存行放 16 个账户，内存最省；同一行里的账户被不同线程频繁修改时会伪共享
+  Padded,  // 每个账户独占一个缓存行，没有伪共享，内存是 Packed 的 16 倍
+};
+
+// 支持并发访问的账户存储
+// 余额保存为 std::atomic<int>，存款是一次 fetch_add，取款是一个 CAS 循环，在竞争下也不会突破透支额度。
+// 账户按编号交错分配到各个分片（id % shards），相邻编号的账户落在不同分片上；每个分片的余额是一块
+// 按缓存行对齐、按整行分配的数组，不同分片的账户不会共用缓存行。同一分片内的账户是否共用缓存行由 AccountLayout 决定
+class AccountStore
+{
+ public:
+  explicit AccountStore( size_t accounts, size_t shards = 64, int overdraft_limit = -500,
+                         AccountLayout layout = AccountLayout::Packed )
+      : shards_( shards ? shards : 1 ),
+        overdraft_limit_( overdraft_limit ),
+        size_( accounts ),
+        per_line_( layout == AccountLayout::Packed ? kSlotsPerLine : 1 )
+  {
+    const size_t per_shard = ( accounts + shards_.size() - 1 ) / shards_.size();
+    const size_t lines     = ( per_shard + per_line_ - 1 ) / per_line_;
+    for ( auto &shard : shards_ ) { shard.lines = std::make_unique<Line[]>( lines ); }
+  }
+
+  void deposit( size_t id, int amount ) { slot( id ).fetch_add( amount, std::memory_order_relaxed ); }
+
+  // 超出透支额度时返回 false，余额不变
+  bool withdraw( size_t id, int amount )
+  {
+    std::atomic<int> &balance = slot( id );
+    int current               = balance.load( std::memory_order_relaxed );
+    do {
+      if ( current - amount < overdraft_limit_ ) { return false; }
+    } while ( !balance.compare_exchange_weak( current, current - amount, std::memory_order_relaxed ) );
+    return true;
+  }
+
+  int balance( size_t id ) const { return slot( id ).load( std::memory_order_relaxed ); }
+
+  size_t size() const { return size_; }
+  int overdraftLimit() const { return overdraft_limit_; }
+  AccountLayout layout() const { return per_line_ == 1 ? AccountLayout::Padded : AccountLayout::Packed; }
+
+ private:
+  static constexpr size_t kSlotsPerLine = 64 / sizeof( std::atomic<int> );
+
+  struct alignas( 64 ) Line {
+    std::atomic<int> slots[ kSlotsPerLine ] = {};
+  };
+  static_assert( sizeof( Line ) == 64 );
+
+  struct Shard {
+    std::unique_ptr<Line[]> lines;
+  };
+
+  std::atomic<int> &slot( size_t id ) const
+  {
+    const size_t index = id / shards_.size();
+    return shards_[ id % shards_.size() ].lines[ index / per_line_ ].slots[ index % per_line_ ];
+  }
+
+  std::vector<Shard> shards_;
+  int overdraft_limit_;
+  size_t size_;
+  size_t per_line_;  // 每个缓存行使用的槽位数：Packed 为 16，Padded 为 1
+};
+
+// 作用于 AccountStore 的原子命令
+struct AtomicDepositCommand : Command {
+  AccountStore &store;
+  size_t id;
+  int amount;
+
+  AtomicDepositCommand( AccountStore &s, size_t account_id, int amt ) : store( s ), id( account_id ), amount( amt ) {}
+
+  void execute() override { store.deposit( id, amount ); }
+  void undo() override { store.withdraw( id, amount ); }
+};
+
+struct AtomicWithdrawCommand : Command {
+  AccountStore &store;
+  size_t id;
+  int amount;
+  bool succeeded = false;
+
+  AtomicWithdrawCommand( AccountStore &s, size_t account_id, int amt ) : store( s ), id( account_id ), amount( amt ) {}
+
+  void execute() override { succeeded = store.withdraw( id, amount ); }
+
+  void undo() override
+  {
+    if ( succeeded ) { store.deposit( id, amount ); }
+  }
+};
+
+}  // namespace DesignPatterns::Command
+
+#endif
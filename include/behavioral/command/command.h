@@ -13,9 +13,12 @@ struct BankAccount {
   int overdraft_limit = -500;
 
   void deposit( int amount ) { balance += amount; }
-  void withdraw( int amount )
+  // 返回是否成功，超出透支额度时余额不变
+  bool withdraw( int amount )
   {
-    if ( balance - amount >= overdraft_limit ) { balance -= amount; }
+    if ( balance - amount < overdraft_limit ) { return false; }
+    balance -= amount;
+    return true;
   }
 
   int getBalance() const { return balance; }  // 查询方法
@@ -45,13 +48,7 @@ struct WithdrawCommand : Command {
 
   WithdrawCommand( BankAccount &acc, int amt ) : account( acc ), amount( amt ) {}
 
-  void execute() override
-  {
-    if ( account.balance - amount >= account.overdraft_limit ) {
-      account.withdraw( amount );
-      succeeded = true;
-    }
-  }
+  void execute() override { succeeded = account.withdraw( amount ); }
 
   void undo() override
   {
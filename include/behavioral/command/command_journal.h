@@ -0,0 +1,209 @@
+#ifndef INCLUDE_BEHAVIORAL_COMMAND_COMMAND_JOURNAL_H
+#define INCLUDE_BEHAVIORAL_COMMAND_COMMAND_JOURNAL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "behavioral/command/command.h"
+
+namespace DesignPatterns::Command
+{
+
+// 内存有上限的撤销 / 重做日志
+// 每条命令只记录为一个 8 字节的增量记录（账户编号 + 实际发生的余额变化），撤销就是减去增量，重做就是加回增量，都是 O(1)。
+// 记录存放在固定大小的块中，块用完后回收复用；超过内存上限时丢弃最旧的块，能撤销的最早位置随之前移。
+// 每隔 checkpoint_interval 条记录保存一次所有账户余额的快照，可以直接跳回快照位置，而不必逐条撤销。
+// 快照的大小与账户数成正比，同样计入内存上限：快照占用多于记录块时先丢弃最旧的快照，单个快照就放不下时不再保存快照
+class CommandJournal
+{
+ public:
+  static constexpr size_t kChunkRecords = 4096;
+
+  explicit CommandJournal( size_t memory_limit_bytes = size_t( 64 ) << 20, size_t checkpoint_interval = 65536 )
+      : memory_limit_( std::max( memory_limit_bytes, 2 * kChunkBytes ) ),
+        checkpoint_interval_( std::max<size_t>( checkpoint_interval, 1 ) )
+  {
+  }
+
+  // 注册账户，返回账户编号。快照只包含保存时已经存在的账户，跳回更早的快照时，
+  // 之后才注册的账户恢复到注册时的余额（那时日志里还没有它的记录）
+  uint32_t addAccount( BankAccount &account )
+  {
+    accounts_.push_back( &account );
+    initial_balances_.push_back( account.balance );
+    return static_cast<uint32_t>( accounts_.size() - 1 );
+  }
+
+  void deposit( uint32_t account, int amount )
+  {
+    prepare();
+    accounts_[ account ]->deposit( amount );
+    append( account, amount );
+  }
+
+  // 超出透支额度时不修改余额，返回 false，但仍然记录一条增量为 0 的记录，保证撤销次数与命令次数一致
+  bool withdraw( uint32_t account, int amount )
+  {
+    prepare();
+    const bool ok = accounts_[ account ]->withdraw( amount );
+    append( account, ok ? -amount : 0 );
+    return ok;
+  }
+
+  bool undo()
+  {
+    if ( cursor_ == begin_ ) { return false; }
+    const Record &r = record( --cursor_ );
+    accounts_[ r.account ]->balance -= r.delta;
+    return true;
+  }
+
+  bool redo()
+  {
+    if ( cursor_ == end_ ) { return false; }
+    const Record &r = record( cursor_++ );
+    accounts_[ r.account ]->balance += r.delta;
+    return true;
+  }
+
+  // 跳回到第 index 个仍然保留的快照（0 为最旧的），之后的记录仍可重做
+  bool restoreSnapshot( size_t index )
+  {
+    if ( index >= snapshots_.size() ) { return false; }
+    const Snapshot &s = snapshots_[ index ];
+    for ( size_t i = 0; i < s.balances.size(); ++i ) { accounts_[ i ]->balance = s.balances[ i ]; }
+    for ( size_t i = s.balances.size(); i < accounts_.size(); ++i ) {
+      accounts_[ i ]->balance = initial_balances_[ i ];
+    }
+    cursor_ = s.position;
+    return true;
+  }
+
+  size_t undoCount() const { return cursor_ - begin_; }
+  size_t redoCount() const { return end_ - cursor_; }
+  size_t snapshotCount() const { return snapshots_.size(); }
+
+  // 当前占用的内存（记录块 + 快照），不含空闲块
+  size_t memoryUsage() const { return chunks_.size() * kChunkBytes + snapshotBytes(); }
+
+ private:
+  struct Record {
+    uint32_t account;
+    int32_t delta;  // 实际发生的余额变化
+  };
+
+  struct Snapshot {
+    uint64_t position;  // 快照对应的是执行完前 position 条记录后的状态
+    std::vector<int> balances;
+  };
+
+  static constexpr size_t kChunkBytes = kChunkRecords * sizeof( Record );
+
+  Record &record( uint64_t position )
+  {
+    return chunks_[ position / kChunkRecords - first_chunk_ ][ position % kChunkRecords ];
+  }
+
+  // 在修改账户之前调用：新命令会丢弃所有可重做的记录，以及它们之后的快照和多余的块，到达检查点时保存快照
+  void prepare()
+  {
+    end_ = cursor_;
+    while ( !snapshots_.empty() && snapshots_.back().position > cursor_ ) {
+      snapshot_bytes_ -= bytesOf( snapshots_.back() );
+      snapshots_.pop_back();
+    }
+    while ( !chunks_.empty() && ( first_chunk_ + chunks_.size() ) * kChunkRecords > end_ + kChunkRecords ) {
+      free_chunks_.push_back( std::move( chunks_.back() ) );
+      chunks_.pop_back();
+    }
+
+    if ( end_ % checkpoint_interval_ == 0 && ( snapshots_.empty() || snapshots_.back().position != end_ ) ) {
+      takeSnapshot();
+    }
+  }
+
+  // 在修改账户之后调用，写入增量记录
+  void append( uint32_t account, int delta )
+  {
+    if ( end_ == ( first_chunk_ + chunks_.size() ) * kChunkRecords ) { chunks_.push_back( allocateChunk() ); }
+
+    record( end_ ) = { account, delta };
+    cursor_ = ++end_;
+    enforceLimit();
+  }
+
+  void takeSnapshot()
+  {
+    // 连同正在写入的块都放不下的快照，保存了也会被立即丢弃
+    if ( sizeof( Snapshot ) + accounts_.size() * sizeof( int ) + kChunkBytes > memory_limit_ ) { return; }
+    Snapshot s;
+    s.position = end_;
+    s.balances.reserve( accounts_.size() );
+    for ( const BankAccount *acc : accounts_ ) { s.balances.push_back( acc->balance ); }
+    snapshot_bytes_ += bytesOf( s );
+    snapshots_.push_back( std::move( s ) );
+    enforceLimit();
+  }
+
+  static size_t bytesOf( const Snapshot &s ) { return sizeof( Snapshot ) + s.balances.capacity() * sizeof( int ); }
+
+  void dropOldestSnapshot()
+  {
+    snapshot_bytes_ -= bytesOf( snapshots_.front() );
+    snapshots_.pop_front();
+  }
+
+  std::unique_ptr<Record[]> allocateChunk()
+  {
+    if ( free_chunks_.empty() ) { return std::make_unique<Record[]>( kChunkRecords ); }
+    auto chunk = std::move( free_chunks_.back() );
+    free_chunks_.pop_back();
+    return chunk;
+  }
+
+  // 超过上限时丢弃最旧的块或最旧的快照，哪一类占用更多就先丢哪一类；当前正在写入的块总是保留
+  void enforceLimit()
+  {
+    while ( memoryUsage() > memory_limit_ ) {
+      const bool drop_chunk =
+          chunks_.size() > 1 && ( snapshots_.empty() || chunks_.size() * kChunkBytes >= snapshot_bytes_ );
+      if ( drop_chunk ) {
+        free_chunks_.push_back( std::move( chunks_.front() ) );
+        chunks_.pop_front();
+        ++first_chunk_;
+        begin_  = std::max<uint64_t>( begin_, first_chunk_ * kChunkRecords );
+        cursor_ = std::max( cursor_, begin_ );
+        while ( !snapshots_.empty() && snapshots_.front().position < begin_ ) { dropOldestSnapshot(); }
+      } else if ( !snapshots_.empty() ) {
+        dropOldestSnapshot();
+      } else {
+        break;
+      }
+    }
+    // 空闲块只保留一个，避免上限之外的内存长期占用
+    if ( free_chunks_.size() > 1 ) { free_chunks_.resize( 1 ); }
+  }
+
+  size_t snapshotBytes() const { return snapshot_bytes_; }
+
+  std::vector<BankAccount *> accounts_;
+  std::vector<int> initial_balances_;  // 注册时的余额
+  std::deque<std::unique_ptr<Record[]>> chunks_;
+  std::vector<std::unique_ptr<Record[]>> free_chunks_;
+  std::deque<Snapshot> snapshots_;
+  size_t snapshot_bytes_ = 0;
+  uint64_t first_chunk_ = 0;  // chunks_[0] 对应的全局块号
+  uint64_t begin_       = 0;  // 最早可以撤销到的位置
+  uint64_t cursor_      = 0;  // 当前位置，之前的记录已生效
+  uint64_t end_         = 0;  // 记录的末尾，[cursor_, end_) 可以重做
+  size_t memory_limit_;
+  size_t checkpoint_interval_;
+};
+
+}  // namespace DesignPatterns::Command
+
+#endif
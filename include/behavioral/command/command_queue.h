@@ -0,0 +1,215 @@
+#ifndef INCLUDE_BEHAVIORAL_COMMAND_COMMAND_QUEUE_H
+#define INCLUDE_BEHAVIORAL_COMMAND_COMMAND_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "behavioral/command/command.h"
+#include "creational/singleton/latency_histogram.h"
+
+namespace DesignPatterns::Command
+{
+
+// 有界的多生产者单消费者无锁环形队列
+// 每个槽位带一个序号：序号等于写位置时可写，等于写位置 + 1 时可读。生产者用 CAS 抢占写位置，
+// 消费者只有一个，读位置不需要原子竞争
+template <typename T>
+class MpscRing
+{
+ public:
+  // 容量向上取 2 的幂，至少为 2：容量为 1 时“已写入”的序号 pos + 1 与“下一圈可写”的序号 pos + cap 相同，
+  // 生产者会覆盖还没被取走的元素
+  explicit MpscRing( size_t capacity = 4096 )
+  {
+    size_t cap = 2;
+    while ( cap < capacity ) { cap <<= 1; }
+    slots_ = std::make_unique<Slot[]>( cap );
+    mask_  = cap - 1;
+    for ( size_t i = 0; i < cap; ++i ) { slots_[ i ].seq.store( i, std::memory_order_relaxed ); }
+  }
+
+  MpscRing( const MpscRing & )            = delete;
+  MpscRing &operator=( const MpscRing & ) = delete;
+
+  // 生产者调用，队列满时返回 false
+  bool try_push( T &value )
+  {
+    size_t pos = tail_.load( std::memory_order_relaxed );
+    for ( ;; ) {
+      Slot &slot     = slots_[ pos & mask_ ];
+      const size_t s = slot.seq.load( std::memory_order_acquire );
+      if ( s == pos ) {
+        if ( tail_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+          slot.value = std::move( value );
+          slot.seq.store( pos + 1, std::memory_order_release );
+          return true;
+        }
+      } else if ( s < pos ) {
+        return false;  // 该槽位还没有被消费者取走，队列已满
+      } else {
+        pos = tail_.load( std::memory_order_relaxed );
+      }
+    }
+  }
+
+  // 只能由唯一的消费者调用，队列空时返回 false
+  bool try_pop( T &out )
+  {
+    Slot &slot = slots_[ head_ & mask_ ];
+    if ( slot.seq.load( std::memory_order_acquire ) != head_ + 1 ) { return false; }
+    out = std::move( slot.value );
+    slot.seq.store( head_ + mask_ + 1, std::memory_order_release );
+    ++head_;
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  alignas( 64 ) std::atomic<size_t> tail_{ 0 };
+  alignas( 64 ) size_t head_ = 0;
+};
+
+// 执行统计
+struct ExecutorStats {
+  size_t executed   = 0;
+  size_t batches    = 0;
+  double seconds    = 0.0;  // 从启动到停止的时间
+  double throughput = 0.0;  // 每秒执行的命令数
+  uint64_t p50_ns   = 0;    // 从提交到执行完成的延迟，取自对数分桶直方图，误差不超过 12.5%
+  uint64_t p99_ns   = 0;
+  uint64_t p999_ns  = 0;
+  uint64_t max_ns   = 0;
+};
+
+// 批量执行器：任意多个线程通过 submit 提交命令，唯一的执行线程按批取出并依次执行
+// 账户只会被执行线程修改，因此不需要为每个账户加锁
+class CommandExecutor
+{
+ public:
+  explicit CommandExecutor( size_t capacity = 65536, size_t batch_size = 256 )
+      : queue_( capacity ), batch_size_( std::max<size_t>( batch_size, 1 ) )
+  {
+  }
+
+  ~CommandExecutor() { stop(); }
+
+  void start()
+  {
+    start_time_ = std::chrono::steady_clock::now();
+    running_.store( true );
+    worker_ = std::jthread( [ this ]( std::stop_token token ) { run( token ); } );
+  }
+
+  // 停止前会先执行完队列中剩余的命令
+  void stop()
+  {
+    if ( worker_.joinable() ) {
+      worker_.request_stop();
+      worker_.join();
+      stop_time_ = std::chrono::steady_clock::now();
+      running_.store( false );
+    }
+  }
+
+  // 队列满时返回 false，由调用者决定是否重试
+  bool try_submit( std::unique_ptr<Command> &cmd )
+  {
+    Item item{ std::move( cmd ), now_ns() };
+    if ( queue_.try_push( item ) ) { return true; }
+    cmd = std::move( item.cmd );
+    return false;
+  }
+
+  // 队列满时让出时间片直到提交成功
+  void submit( std::unique_ptr<Command> cmd )
+  {
+    while ( !try_submit( cmd ) ) { std::this_thread::yield(); }
+  }
+
+  // 运行期间也可以调用：计数只由执行线程递增，这里读到的是某一时刻的近似值，时间算到当前
+  ExecutorStats stats() const
+  {
+    ExecutorStats s;
+    const auto latencies = histogram_.snapshot();
+    s.executed           = latencies.total;
+    s.batches            = batches_.load( std::memory_order_relaxed );
+    const auto end_time  = running_.load() ? std::chrono::steady_clock::now() : stop_time_;
+    s.seconds            = std::chrono::duration<double>( end_time - start_time_ ).count();
+    if ( s.seconds > 0.0 ) { s.throughput = static_cast<double>( s.executed ) / s.seconds; }
+    s.p50_ns  = latencies.percentile( 0.5 );
+    s.p99_ns  = latencies.percentile( 0.99 );
+    s.p999_ns = latencies.percentile( 0.999 );
+    s.max_ns  = max_ns_.load( std::memory_order_relaxed );
+    return s;
+  }
+
+ private:
+  struct Item {
+    std::unique_ptr<Command> cmd;
+    uint64_t submitted_ns = 0;
+  };
+
+  static uint64_t now_ns()
+  {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() )
+            .count() );
+  }
+
+  // 只有执行线程写入，用 load + store 代替原子加法
+  void record( uint64_t ns )
+  {
+    histogram_.record_single_writer( ns );
+    if ( ns > max_ns_.load( std::memory_order_relaxed ) ) { max_ns_.store( ns, std::memory_order_relaxed ); }
+  }
+
+  // 一次最多取出 batch_size 个命令执行，队列空时让出时间片
+  size_t drain_batch()
+  {
+    size_t count = 0;
+    Item item;
+    while ( count < batch_size_ && queue_.try_pop( item ) ) {
+      item.cmd->execute();
+      record( now_ns() - item.submitted_ns );
+      item.cmd.reset();
+      ++count;
+    }
+    if ( count > 0 ) { batches_.store( batches_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ); }
+    return count;
+  }
+
+  void run( std::stop_token token )
+  {
+    while ( !token.stop_requested() ) {
+      if ( drain_batch() == 0 ) { std::this_thread::yield(); }
+    }
+    while ( drain_batch() > 0 ) {}
+  }
+
+  MpscRing<Item> queue_;
+  size_t batch_size_;
+  std::atomic<size_t> batches_{ 0 };
+  Singleton::LatencyHistogram histogram_;  // 从提交到执行完成的延迟
+  std::atomic<uint64_t> max_ns_{ 0 };
+  std::atomic<bool> running_{ false };
+  std::chrono::steady_clock::time_point start_time_;
+  std::chrono::steady_clock::time_point stop_time_;
+  std::jthread worker_;
+};
+
+}  // namespace DesignPatterns::Command
+
+#endif
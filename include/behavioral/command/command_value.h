@@ -0,0 +1,170 @@
+#ifndef INCLUDE_BEHAVIORAL_COMMAND_COMMAND_VALUE_H
+#define INCLUDE_BEHAVIORAL_COMMAND_COMMAND_VALUE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "behavioral/command/command.h"
+
+namespace DesignPatterns::Command
+{
+
+// 任何提供 execute() / undo() 的类型都可以作为命令，不要求继承 Command
+template <typename T>
+concept CommandLike = requires( T &t ) {
+  t.execute();
+  t.undo();
+};
+
+// 值语义的命令：使用小缓冲区做类型擦除，命令对象直接存放在 CommandValue 内部，不需要堆分配
+// 可以像普通值一样放进 std::vector，连续存放。放不进缓冲区的命令（太大、对齐要求过高或移动可能抛异常）
+// 退回到堆上，缓冲区里只存指针，用法不变
+class CommandValue
+{
+ public:
+  static constexpr size_t kBufferSize = 48;
+
+  // U 是否直接存放在内部缓冲区中
+  template <typename U>
+  static constexpr bool kStoredInline = sizeof( U ) <= kBufferSize && alignof( U ) <= alignof( std::max_align_t ) &&
+                                        std::is_nothrow_move_constructible_v<U>;
+
+  CommandValue() = default;
+
+  template <CommandLike T>
+    requires( !std::is_same_v<std::decay_t<T>, CommandValue> )
+  CommandValue( T &&cmd )
+  {
+    using U = std::decay_t<T>;
+    if constexpr ( kStoredInline<U> ) {
+      ::new ( static_cast<void *>( buffer_ ) ) U( std::forward<T>( cmd ) );
+      ops_ = &opsFor<U>;
+    } else {
+      ::new ( static_cast<void *>( buffer_ ) ) U *( new U( std::forward<T>( cmd ) ) );
+      ops_ = &heapOpsFor<U>;
+    }
+  }
+
+  CommandValue( CommandValue &&other ) noexcept
+  {
+    if ( other.ops_ ) {
+      other.ops_->move( other.buffer_, buffer_ );
+      ops_ = other.ops_;
+      other.reset();
+    }
+  }
+
+  CommandValue &operator=( CommandValue &&other ) noexcept
+  {
+    if ( this != &other ) {
+      reset();
+      if ( other.ops_ ) {
+        other.ops_->move( other.buffer_, buffer_ );
+        ops_ = other.ops_;
+        other.reset();
+      }
+    }
+    return *this;
+  }
+
+  CommandValue( const CommandValue & )            = delete;
+  CommandValue &operator=( const CommandValue & ) = delete;
+
+  ~CommandValue() { reset(); }
+
+  void execute() { ops_->execute( buffer_ ); }
+  void undo() { ops_->undo( buffer_ ); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  // 当前命令是否放在堆上
+  bool onHeap() const { return ops_ && ops_->heap; }
+
+ private:
+  struct Ops {
+    void ( *execute )( void * );
+    void ( *undo )( void * );
+    void ( *move )( void *from, void *to );
+    void ( *destroy )( void * );
+    bool heap;
+  };
+
+  template <typename U>
+  static constexpr Ops opsFor = {
+      []( void *p ) { static_cast<U *>( p )->execute(); },
+      []( void *p ) { static_cast<U *>( p )->undo(); },
+      []( void *from, void *to ) { ::new ( to ) U( std::move( *static_cast<U *>( from ) ) ); },
+      []( void *p ) { static_cast<U *>( p )->~U(); },
+      false,
+  };
+
+  // 缓冲区里存的是 U *，移动只转移指针，原来的 CommandValue 随后析构时删除的是空指针
+  template <typename U>
+  static constexpr Ops heapOpsFor = {
+      []( void *p ) { ( *static_cast<U **>( p ) )->execute(); },
+      []( void *p ) { ( *static_cast<U **>( p ) )->undo(); },
+      []( void *from, void *to ) { ::new ( to ) U *( std::exchange( *static_cast<U **>( from ), nullptr ) ); },
+      []( void *p ) { delete *static_cast<U **>( p ); },
+      true,
+  };
+
+  void reset()
+  {
+    if ( ops_ ) {
+      ops_->destroy( buffer_ );
+      ops_ = nullptr;
+    }
+  }
+
+  alignas( std::max_align_t ) unsigned char buffer_[ kBufferSize ];
+  const Ops *ops_ = nullptr;
+};
+
+// 扁平的撤销 / 重做历史：所有命令连续存放在一个 vector 中，cursor 之前是已执行的，之后是可重做的
+class CommandHistory
+{
+ public:
+  // 执行新命令会丢弃所有可重做的命令
+  void execute( CommandValue cmd )
+  {
+    commands_.erase( commands_.begin() + static_cast<std::ptrdiff_t>( cursor_ ), commands_.end() );
+    commands_.push_back( std::move( cmd ) );
+    commands_.back().execute();
+    ++cursor_;
+  }
+
+  bool undo()
+  {
+    if ( cursor_ == 0 ) { return false; }
+    commands_[ --cursor_ ].undo();
+    return true;
+  }
+
+  bool redo()
+  {
+    if ( cursor_ == commands_.size() ) { return false; }
+    commands_[ cursor_++ ].execute();
+    return true;
+  }
+
+  void reserve( size_t n ) { commands_.reserve( n ); }
+  void clear()
+  {
+    commands_.clear();
+    cursor_ = 0;
+  }
+
+  size_t undoCount() const { return cursor_; }
+  size_t redoCount() const { return commands_.size() - cursor_; }
+
+ private:
+  std::vector<CommandValue> commands_;
+  size_t cursor_ = 0;
+};
+
+}  // namespace DesignPatterns::Command
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef INCLUDE_BEHAVIORAL_COMMAND_COMMAND_WAL_H
+#define INCLUDE_BEHAVIORAL_COMMAND_COMMAND_WAL_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "behavioral/command/command.h"
+
+namespace DesignPatterns::Command
+{
+
+// 命令的预写日志（WAL）
+// 日志由若干个固定大小的段文件组成（000000.wal, 000001.wal, ...），每个段通过 mmap 映射，追加记录只是一次内存拷贝；
+// 何时把数据刷到磁盘由 Durability 决定，多条命令可以共享一次 msync（组提交）。
+// append / commit / sync 只能由一个线程调用；Interval 模式下另有一个后台线程定期刷盘。
+// 启动时用 replay 逐段流式读取日志重建账户状态，整个日志不会一次性读入内存
+
+enum class WalOp : uint32_t { Deposit = 1, Withdraw = 2 };
+
+struct WalRecord {
+  uint32_t account;
+  int32_t amount;
+  WalOp op;
+  uint32_t checksum;
+};
+
+enum class Durability {
+  None,      // 从不主动刷盘，交给操作系统
+  PerBatch,  // 每次 commit() 都刷盘
+  Interval,  // 后台线程每隔 interval 把已经 commit() 的记录刷盘，提交之后最多 interval 就会落盘
+};
+
+namespace detail
+{
+
+constexpr uint32_t kWalMagic   = 0x4c415743;  // "CWAL"
+constexpr uint32_t kWalVersion = 1;
+
+struct WalSegmentHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t index;
+};
+
+inline uint32_t walChecksum( const WalRecord &r )
+{
+  uint32_t h                 = 2166136261u;
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>( &r );
+  for ( size_t i = 0; i < offsetof( WalRecord, checksum ); ++i ) { h = ( h ^ bytes[ i ] ) * 16777619u; }
+  return h;
+}
+
+inline std::filesystem::path walSegmentPath( const std::filesystem::path &dir, uint64_t index )
+{
+  char name[ 32 ];
+  std::snprintf( name, sizeof( name ), "%06llu.wal", static_cast<unsigned long long>( index ) );
+  return dir / name;
+}
+
+// 按编号升序列出目录中的所有段；名字不全是数字的 .wal 文件（如备份）不是段，跳过
+inline std::vector<uint64_t> walSegments( const std::filesystem::path &dir )
+{
+  std::vector<uint64_t> result;
+  if ( !std::filesystem::exists( dir ) ) { return result; }
+  for ( const auto &entry : std::filesystem::directory_iterator( dir ) ) {
+    if ( entry.path().extension() != ".wal" ) { continue; }
+    const std::string stem = entry.path().stem().string();
+    uint64_t index         = 0;
+    const auto [ end, ec ] = std::from_chars( stem.data(), stem.data() + stem.size(), index );
+    if ( !stem.empty() && ec == std::errc() && end == stem.data() + stem.size() ) { result.push_back( index ); }
+  }
+  std::sort( result.begin(), result.end() );
+  return result;
+}
+
+inline bool walRecordValid( const WalRecord &r )
+{
+  return ( r.op == WalOp::Deposit || r.op == WalOp::Withdraw ) && r.checksum == walChecksum( r );
+}
+
+}  // namespace detail
+
+struct WalOptions {
+  size_t segment_size                = size_t( 64 ) << 20;
+  Durability durability              = Durability::PerBatch;
+  std::chrono::milliseconds interval = std::chrono::milliseconds( 10 );
+};
+
+class WriteAheadLog
+{
+ public:
+  using Options = WalOptions;
+
+  // 打开目录中的日志；已有日志时从最后一个段的末尾继续追加
+  explicit WriteAheadLog( const std::filesystem::path &dir, Options options = {} ) : dir_( dir ), options_( options )
+  {
+    options_.segment_size = std::max( options_.segment_size, sizeof( detail::WalSegmentHeader ) + sizeof( WalRecord ) );
+    std::filesystem::create_directories( dir_ );
+    auto segments = detail::walSegments( dir_ );
+    openSegment( segments.empty() ? 0 : segments.back() );
+    if ( options_.durability == Durability::Interval ) {
+      flusher_ = std::jthread( [ this ]( std::stop_token token ) { runFlusher( token ); } );
+    }
+  }
+
+  WriteAheadLog( const WriteAheadLog & )            = delete;
+  WriteAheadLog &operator=( const WriteAheadLog & ) = delete;
+
+  ~WriteAheadLog()
+  {
+    if ( flusher_.joinable() ) {
+      flusher_.request_stop();
+      flusher_.join();
+    }
+    if ( options_.durability != Durability::None ) { sync(); }
+    closeSegment();
+  }
+
+  // 追加一条记录，只写入映射内存，不做系统调用（换段除外）
+  void append( uint32_t account, WalOp op, int amount )
+  {
+    if ( offset_ + sizeof( WalRecord ) > options_.segment_size ) {
+      std::lock_guard<std::mutex> lock( mutex_ );  // 后台线程不能在换段时访问映射
+      if ( options_.durability != Durability::None ) { syncLocked(); }
+      closeSegment();
+      openSegment( segment_index_ + 1 );
+    }
+    WalRecord r{ account, amount, op, 0 };
+    r.checksum = detail::walChecksum( r );
+    std::memcpy( base_ + offset_, &r, sizeof( r ) );
+    offset_ += sizeof( r );
+  }
+
+  // 组提交：按照 Durability 决定是否把自上次刷盘以来追加的记录写到磁盘
+  void commit()
+  {
+    switch ( options_.durability ) {
+      case Durability::None: return;
+      case Durability::PerBatch: sync(); return;
+      case Durability::Interval: committed_.store( offset_, std::memory_order_release ); return;  // 交给后台线程
+    }
+  }
+
+  // 立即刷盘
+  void sync()
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    syncLocked();
+  }
+
+  // 已经 commit() 但还没有刷盘的字节数（当前段）
+  size_t unsyncedCommitted()
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    const size_t committed = committed_.load( std::memory_order_acquire );
+    return committed > synced_ ? committed - synced_ : 0;
+  }
+
+  // 流式回放目录中的所有记录，fn 以 const WalRecord & 为参数，返回回放的记录数
+  template <typename Fn>
+  static size_t replay( const std::filesystem::path &dir, Fn &&fn )
+  {
+    size_t count = 0;
+    for ( uint64_t index : detail::walSegments( dir ) ) {
+      const auto path = detail::walSegmentPath( dir, index );
+      int fd          = ::open( path.c_str(), O_RDONLY );
+      if ( fd < 0 ) { throw std::runtime_error( "WriteAheadLog: cannot open " + path.string() ); }
+      struct stat st{};
+      if ( ::fstat( fd, &st ) != 0 ) {
+        ::close( fd );
+        throw std::runtime_error( "WriteAheadLog: cannot stat " + path.string() );
+      }
+      const size_t size = static_cast<size_t>( st.st_size );
+      if ( size < sizeof( detail::WalSegmentHeader ) ) {
+        ::close( fd );
+        continue;
+      }
+      void *map = ::mmap( nullptr, size, PROT_READ, MAP_SHARED, fd, 0 );
+      ::close( fd );
+      if ( map == MAP_FAILED ) { throw std::runtime_error( "WriteAheadLog: mmap failed for " + path.string() ); }
+      ::madvise( map, size, MADV_SEQUENTIAL );
+
+      const auto *bytes = static_cast<const unsigned char *>( map );
+      detail::WalSegmentHeader header;
+      std::memcpy( &header, bytes, sizeof( header ) );
+      if ( header.magic == detail::kWalMagic && header.version == detail::kWalVersion ) {
+        for ( size_t off = sizeof( header ); off + sizeof( WalRecord ) <= size; off += sizeof( WalRecord ) ) {
+          WalRecord r;
+          std::memcpy( &r, bytes + off, sizeof( r ) );
+          if ( !detail::walRecordValid( r ) ) { break; }  // 段的剩余部分未写入或最后一条记录不完整
+          fn( static_cast<const WalRecord &>( r ) );
+          ++count;
+        }
+      }
+      ::munmap( map, size );
+    }
+    return count;
+  }
+
+  // 用日志重建账户状态，accounts 的下标即记录中的账户编号，取款按照与执行时相同的透支规则重放
+  static size_t replayInto( const std::filesystem::path &dir, std::vector<BankAccount> &accounts )
+  {
+    return replay( dir, [ &accounts ]( const WalRecord &r ) {
+      if ( r.account >= accounts.size() ) { accounts.resize( r.account + 1 ); }
+      if ( r.op == WalOp::Deposit ) {
+        accounts[ r.account ].deposit( r.amount );
+      } else {
+        accounts[ r.account ].withdraw( r.amount );
+      }
+    } );
+  }
+
+ private:
+  // 把当前段中 end 之前的记录刷盘，调用方持有 mutex_
+  void syncTo( size_t end )
+  {
+    if ( synced_ < end ) {
+      const size_t page  = static_cast<size_t>( ::sysconf( _SC_PAGESIZE ) );
+      const size_t begin = synced_ / page * page;
+      if ( ::msync( base_ + begin, end - begin, MS_SYNC ) != 0 ) {
+        throw std::runtime_error( "WriteAheadLog: msync failed" );
+      }
+      synced_ = end;
+    }
+  }
+
+  void syncLocked() { syncTo( offset_ ); }
+
+  // Interval 模式的后台线程：每隔 interval 把已经提交的记录刷盘
+  void runFlusher( std::stop_token token )
+  {
+    std::mutex wait_mutex;
+    std::condition_variable_any wake;
+    std::unique_lock<std::mutex> wait_lock( wait_mutex );
+    for ( ;; ) {
+      wake.wait_for( wait_lock, token, options_.interval, [] { return false; } );  // 只等超时或停止
+      if ( token.stop_requested() ) { return; }
+      std::lock_guard<std::mutex> lock( mutex_ );
+      try {
+        syncTo( committed_.load( std::memory_order_acquire ) );
+      } catch ( const std::runtime_error & ) {  // 下一轮重试，析构时的 sync 会抛出
+      }
+    }
+  }
+
+  void openSegment( uint64_t index )
+  {
+    const auto path  = detail::walSegmentPath( dir_, index );
+    const bool fresh = !std::filesystem::exists( path );
+    if ( !fresh && std::filesystem::file_size( path ) != options_.segment_size ) {
+      openSegment( index + 1 );  // 段大小与当前配置不同，不在旧段上续写
+      return;
+    }
+    fd_ = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+    if ( fd_ < 0 ) { throw std::runtime_error( "WriteAheadLog: cannot open " + path.string() ); }
+    if ( ::ftruncate( fd_, static_cast<off_t>( options_.segment_size ) ) != 0 ) {
+      throw std::runtime_error( "WriteAheadLog: ftruncate failed for " + path.string() );
+    }
+    void *map = ::mmap( nullptr, options_.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0 );
+    if ( map == MAP_FAILED ) { throw std::runtime_error( "WriteAheadLog: mmap failed for " + path.string() ); }
+    base_          = static_cast<unsigned char *>( map );
+    segment_index_ = index;
+
+    detail::WalSegmentHeader header{ detail::kWalMagic, detail::kWalVersion, index };
+    if ( fresh ) {
+      std::memcpy( base_, &header, sizeof( header ) );
+      offset_ = sizeof( header );
+      synced_ = 0;
+      committed_.store( offset_, std::memory_order_release );
+      return;
+    }
+
+    // 已有的段：跳过所有有效记录，从第一条无效记录处继续写
+    offset_ = sizeof( header );
+    while ( offset_ + sizeof( WalRecord ) <= options_.segment_size ) {
+      WalRecord r;
+      std::memcpy( &r, base_ + offset_, sizeof( r ) );
+      if ( !detail::walRecordValid( r ) ) { break; }
+      offset_ += sizeof( r );
+    }
+    synced_ = offset_;
+    committed_.store( offset_, std::memory_order_release );
+  }
+
+  void closeSegment()
+  {
+    if ( base_ ) {
+      ::munmap( base_, options_.segment_size );
+      base_ = nullptr;
+    }
+    if ( fd_ >= 0 ) {
+      ::close( fd_ );
+      fd_ = -1;
+    }
+  }
+
+  std::filesystem::path dir_;
+  Options options_;
+  int fd_                 = -1;
+  unsigned char *base_    = nullptr;
+  uint64_t segment_index_ = 0;
+  size_t offset_          = 0;  // 下一条记录的写入位置
+  size_t synced_          = 0;        // 已经刷盘的位置，只在 mutex_ 下修改
+  std::atomic<size_t> committed_{ 0 };  // 当前段中最后一次 commit() 的位置，后台线程刷到这里
+  std::mutex mutex_;                    // 刷盘和换段互斥
+  std::jthread flusher_;
+};
+
+// 带日志的命令：先写日志再修改账户
+struct LoggedDepositCommand : DepositCommand {
+  WriteAheadLog &wal;
+  uint32_t id;
+
+  LoggedDepositCommand( WriteAheadLog &log, uint32_t account_id, BankAccount &acc, int amt )
+      : DepositCommand( acc, amt ), wal( log ), id( account_id )
+  {
+  }
+
+  void execute() override
+  {
+    wal.append( id, WalOp::Deposit, amount );
+    DepositCommand::execute();
+  }
+
+  void undo() override
+  {
+    wal.append( id, WalOp::Withdraw, amount );
+    DepositCommand::undo();
+  }
+};
+
+struct LoggedWithdrawCommand : WithdrawCommand {
+  WriteAheadLog &wal;
+  uint32_t id;
+
+  LoggedWithdrawCommand( WriteAheadLog &log, uint32_t account_id, BankAccount &acc, int amt )
+      : WithdrawCommand( acc, amt ), wal( log ), id( account_id )
+  {
+  }
+
+  void execute() override
+  {
+    wal.append( id, WalOp::Withdraw, amount );
+    WithdrawCommand::execute();
+  }
+
+  void undo() override
+  {
+    if ( succeeded ) { wal.append( id, WalOp::Deposit, amount ); }
+    WithdrawCommand::undo();
+  }
+};
+
+}  // namespace DesignPatterns::Command
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_DIAGNOSTICS_H
+#define INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_DIAGNOSTICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace DesignPatterns::ResponsibilityChain
+{
+
+// 结构化的校验诊断：只记录错误码、出错的校验、点下标和出错的值，需要时再格式化成文本
+enum class CheckId : uint8_t { Length, Dimension, Velocity, Limit, VelocityContinuity };
+
+enum class CheckError : uint8_t {
+  EmptyPath,            // 路径为空
+  BadDimension,         // 关节数不为 6，value 为实际关节数
+  NonPositiveVelocity,  // 速度 <= 0，value 为速度
+  OutOfLimit,           // 关节越限，value 为越限的关节值
+  BadBufferSize,        // SoA 关节缓冲区大小与点数不匹配，value 为缓冲区大小，index 为点数
+  VelocityJump,         // 相邻两点速度差超限，value 为速度差
+};
+
+struct Diagnostic {
+  CheckError code;
+  CheckId check;
+  size_t index;
+  double value;
+};
+
+// 格式化与原先直接写 std::cerr 的文本保持一致
+inline std::ostream &operator<<( std::ostream &os, const Diagnostic &d )
+{
+  switch ( d.code ) {
+    case CheckError::EmptyPath: return os << "[Joint] path is empty";
+    case CheckError::BadDimension: return os << "[Joint] joint size != 6 at index " << d.index;
+    case CheckError::NonPositiveVelocity: return os << "[Joint] velocity <= 0 at index " << d.index;
+    case CheckError::OutOfLimit: return os << "[Joint] joint out of limit at index " << d.index;
+    case CheckError::VelocityJump: return os << "[Joint] velocity jump " << d.value << " at index " << d.index;
+    case CheckError::BadBufferSize:
+      return os << "[Joint] joint buffer size " << static_cast<size_t>( d.value ) << " != 6 * " << d.index;
+  }
+  return os;
+}
+
+inline std::string toString( const Diagnostic &d )
+{
+  std::ostringstream os;
+  os << d;
+  return os.str();
+}
+
+// 单生产者单消费者的无锁环形缓冲区，容量在构造时一次性分配
+// 每个校验线程持有自己的一个环（生产者），由另一个线程异步取出（消费者）；
+// 写满时新的诊断被丢弃并计数，校验线程永远不会阻塞或分配内存
+class DiagnosticRing
+{
+ public:
+  explicit DiagnosticRing( size_t capacity = 1024 )
+  {
+    size_t cap = 1;
+    while ( cap < capacity ) { cap <<= 1; }
+    buffer_ = std::make_unique<Diagnostic[]>( cap );
+    mask_   = cap - 1;
+  }
+
+  DiagnosticRing( const DiagnosticRing & )            = delete;
+  DiagnosticRing &operator=( const DiagnosticRing & ) = delete;
+
+  // 生产者调用
+  bool push( const Diagnostic &d ) noexcept
+  {
+    const size_t tail = tail_.load( std::memory_order_relaxed );
+    if ( tail - head_.load( std::memory_order_acquire ) > mask_ ) {
+      dropped_.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+    buffer_[ tail & mask_ ] = d;
+    tail_.store( tail + 1, std::memory_order_release );
+    return true;
+  }
+
+  // 消费者调用
+  bool pop( Diagnostic &d ) noexcept
+  {
+    const size_t head = head_.load( std::memory_order_relaxed );
+    if ( head == tail_.load( std::memory_order_acquire ) ) { return false; }
+    d = buffer_[ head & mask_ ];
+    head_.store( head + 1, std::memory_order_release );
+    return true;
+  }
+
+  // 消费者调用：取出当前所有诊断并交给回调，返回取出的条数
+  template <typename Fn>
+  size_t drain( Fn &&fn )
+  {
+    size_t count = 0;
+    Diagnostic d;
+    while ( pop( d ) ) {
+      fn( d );
+      ++count;
+    }
+    return count;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+  size_t dropped() const { return dropped_.load( std::memory_order_relaxed ); }
+
+ private:
+  std::unique_ptr<Diagnostic[]> buffer_;
+  size_t mask_ = 0;
+  alignas( 64 ) std::atomic<size_t> head_{ 0 };
+  alignas( 64 ) std::atomic<size_t> tail_{ 0 };
+  std::atomic<size_t> dropped_{ 0 };
+};
+
+// 有环就写入环，没有则退回到原来的 std::cerr 输出
+inline void report( DiagnosticRing *ring, const Diagnostic &d )
+{
+  if ( ring ) {
+    ring->push( d );
+  } else {
+    std::cerr << d << "\n";
+  }
+}
+
+}  // namespace DesignPatterns::ResponsibilityChain
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_INCREMENTAL_CHECK_H
+#define INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_INCREMENTAL_CHECK_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "behavioral/responsibility_chain/responsibility_chain.h"
+
+namespace DesignPatterns::ResponsibilityChain
+{
+
+// 增量校验会话：记住已经通过校验的前缀 [0, validated)
+// 追加点之后调用 validate()，只检查新追加的部分；
+// 修改了 [begin, end) 之后调用 edit()，只重新检查受影响的范围 [begin, end + lookback)，
+// 其中 lookback 来自链上的窗口校验（如速度连续性）。每次更新的开销只与变化量有关，与路径总长度无关
+template <typename Chain = JointCheckChain>
+class ValidationSession
+{
+ public:
+  explicit ValidationSession( const JointPath &path ) : path_( path ) {}
+
+  // 检查自上次校验以来追加的点
+  bool validate()
+  {
+    const size_t n = path_.points.size();
+    validated_     = std::min( validated_, n );  // 路径被截短
+    if ( !chain_.checkPath( path_ ) ) { return false; }
+    return checkRange( validated_, n );
+  }
+
+  // 通知会话 [begin, end) 范围内的点被修改过，重新检查受影响的部分以及之后追加的点
+  bool edit( size_t begin, size_t end )
+  {
+    if ( begin < validated_ ) {
+      const size_t stop = std::min( end + Chain::lookback(), validated_ );
+      if ( !chain_.checkPath( path_ ) ) { return false; }
+      if ( begin < stop ) {
+        const size_t bad = chain_.findFirstFailure( path_, begin, stop );
+        if ( bad != stop ) {
+          validated_ = bad;
+          return chain_.checkPoint( path_, bad );
+        }
+      }
+    }
+    return validate();
+  }
+
+  // 丢弃所有缓存的结果，下次从头开始检查
+  void reset() { validated_ = 0; }
+
+  size_t validated() const { return validated_; }
+  Chain &chain() { return chain_; }
+
+ private:
+  // 检查 [begin, end)，全部通过时把已校验前缀推进到 end
+  bool checkRange( size_t begin, size_t end )
+  {
+    const size_t bad = chain_.findFirstFailure( path_, begin, end );
+    if ( bad != end ) {
+      validated_ = bad;
+      return chain_.checkPoint( path_, bad );  // 输出诊断
+    }
+    validated_ = end;
+    return true;
+  }
+
+  const JointPath &path_;
+  Chain chain_;
+  size_t validated_ = 0;
+};
+
+}  // namespace DesignPatterns::ResponsibilityChain
+
+#endif
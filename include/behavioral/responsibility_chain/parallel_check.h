@@ -0,0 +1,147 @@
+#ifndef INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_PARALLEL_CHECK_H
+#define INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_PARALLEL_CHECK_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "behavioral/responsibility_chain/responsibility_chain.h"
+
+namespace DesignPatterns::ResponsibilityChain
+{
+
+// 超长路径的并行校验
+// 路径被切成固定大小的块，工作线程从一个共享游标上按顺序“领取”下一个块，
+// 先做完的线程自然会去领取剩下的块，达到与工作窃取相同的负载均衡效果。
+// 某个块出错后记录最小的出错下标，起点不小于该下标的块直接跳过，其余线程随之尽快停止。
+// 由于块是按下标递增的顺序领取的，所有起点更小的块一定会被完整检查，因此最终得到的就是全局最小的出错下标，
+// 诊断信息只针对这一个点输出，与串行的 CheckChain 一致。
+template <typename Chain>
+class ParallelChainValidator
+{
+ public:
+  // chunk_size 默认 4096 个点，大约是一个 L2 缓存能容纳的 JointPoint 及其关节数据
+  // 工作线程在构造时创建一次并常驻，之后每次 check() 只需唤醒它们，中等长度的路径也不必为建线程付出几十微秒
+  explicit ParallelChainValidator( size_t threads = std::thread::hardware_concurrency(), size_t chunk_size = 4096 )
+      : threads_( std::max<size_t>( threads, 1 ) ), chunk_size_( std::max<size_t>( chunk_size, 1 ) )
+  {
+    for ( size_t i = 1; i < threads_; ++i ) {
+      workers_.emplace_back( [ this ]( std::stop_token token ) { run( token ); } );
+    }
+  }
+
+  ParallelChainValidator( const ParallelChainValidator & )            = delete;
+  ParallelChainValidator &operator=( const ParallelChainValidator & ) = delete;
+
+  // 多个线程同时调用时，拿不到工作线程的调用退回到串行检查
+  bool check( const JointPath &path ) const
+  {
+    if ( !chain_.checkPath( path ) ) { return false; }
+
+    const size_t n       = path.points.size();
+    const size_t chunks  = ( n + chunk_size_ - 1 ) / chunk_size_;
+    const size_t helpers = std::min( threads_, chunks ) - ( chunks > 0 ? 1 : 0 );
+
+    size_t bad = n;
+    std::unique_lock<std::mutex> busy( check_mutex_, std::try_to_lock );
+    if ( helpers == 0 || !busy.owns_lock() ) {
+      bad = chain_.findFirstFailure( path, 0, n );
+    } else {
+      job_.path   = &path;
+      job_.chunks = chunks;
+      job_.next_chunk.store( 0, std::memory_order_relaxed );
+      job_.first_bad.store( n, std::memory_order_relaxed );
+      {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        ++generation_;
+        wanted_ = helpers;
+      }
+      wake_.notify_all();
+
+      drain();
+
+      // 还没醒来的工作线程不再需要，只等已经在领取块的线程退出
+      std::unique_lock<std::mutex> lock( mutex_ );
+      wanted_ = 0;
+      idle_.wait( lock, [ this ]() { return running_ == 0; } );
+      bad = job_.first_bad.load( std::memory_order_relaxed );
+    }
+
+    if ( bad == n ) { return true; }
+    return chain_.checkPoint( path, bad );  // 只为最小的出错点输出诊断
+  }
+
+  Chain &chain() { return chain_; }
+
+ private:
+  // 一次 check() 的共享状态，由 check_mutex_ 保证同一时刻只有一个
+  struct Job {
+    const JointPath *path = nullptr;
+    size_t chunks         = 0;
+    std::atomic<size_t> next_chunk{ 0 };
+    std::atomic<size_t> first_bad{ 0 };
+  };
+
+  void drain() const
+  {
+    const JointPath &path = *job_.path;
+    const size_t n        = path.points.size();
+    for ( ;; ) {
+      const size_t chunk = job_.next_chunk.fetch_add( 1, std::memory_order_relaxed );
+      if ( chunk >= job_.chunks ) { return; }
+
+      const size_t begin = chunk * chunk_size_;
+      if ( begin >= job_.first_bad.load( std::memory_order_relaxed ) ) { return; }
+
+      const size_t end = std::min( begin + chunk_size_, n );
+      const size_t bad = chain_.findFirstFailure( path, begin, end );
+      if ( bad != end ) {
+        size_t current = job_.first_bad.load( std::memory_order_relaxed );
+        while ( bad < current && !job_.first_bad.compare_exchange_weak( current, bad, std::memory_order_relaxed ) ) {}
+        return;
+      }
+    }
+  }
+
+  void run( std::stop_token token ) const
+  {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock( mutex_ );
+    for ( ;; ) {
+      wake_.wait( lock, token, [ & ]() { return generation_ != seen; } );
+      if ( token.stop_requested() ) { return; }
+      seen = generation_;
+      if ( wanted_ == 0 ) { continue; }
+      --wanted_;
+      ++running_;
+      lock.unlock();
+      drain();
+      lock.lock();
+      if ( --running_ == 0 ) { idle_.notify_one(); }
+    }
+  }
+
+  size_t threads_;
+  size_t chunk_size_;
+  Chain chain_;
+
+  mutable std::mutex check_mutex_;
+  mutable Job job_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable_any wake_;
+  mutable std::condition_variable idle_;
+  mutable uint64_t generation_ = 0;
+  mutable size_t wanted_       = 0;
+  mutable size_t running_      = 0;
+  std::vector<std::jthread> workers_;  // 最后声明，最先析构：jthread 析构时请求停止并 join
+};
+
+}  // namespace DesignPatterns::ResponsibilityChain
+
+#endif
@@ -1,11 +1,18 @@
 #ifndef INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_RESPONSIBILITY_CHAIN_H
 #define INCLUDE_BEHAVIORAL_RESPONSIBILITY_CHAIN_RESPONSIBILITY_CHAIN_H
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "behavioral/responsibility_chain/diagnostics.h"
+
 namespace DesignPatterns::ResponsibilityChain
 {
 
@@ -19,8 +26,62 @@ struct JointPath {
   std::vector<JointPoint> points;
 };
 
+// 关节限位，默认不限制
+struct JointLimits {
+  std::array<double, 6> lower;
+  std::array<double, 6> upper;
+
+  JointLimits()
+  {
+    lower.fill( -std::numeric_limits<double>::infinity() );
+    upper.fill( std::numeric_limits<double>::infinity() );
+  }
+};
+
+// 结构体数组（SoA）形式的路径：所有关节值连续存放在一块 6×N 的缓冲区中，速度单独一列
+struct JointPathSoA {
+  static constexpr size_t kDof = 6;
+
+  std::vector<double> joints;  // 第 i 个点的关节值位于 [i * kDof, i * kDof + kDof)
+  std::vector<double> velocities;
+
+  size_t size() const { return velocities.size(); }
+  bool empty() const { return velocities.empty(); }
+
+  void reserve( size_t n )
+  {
+    joints.reserve( n * kDof );
+    velocities.reserve( n );
+  }
+
+  void push_back( const std::array<double, kDof> &q, double velocity )
+  {
+    joints.insert( joints.end(), q.begin(), q.end() );
+    velocities.push_back( velocity );
+  }
+
+  // 从 AoS 路径转换，遇到维度不为 6 的点时停止并通过 bad_index 返回其下标
+  static bool fromJointPath( const JointPath &path, JointPathSoA &out, size_t *bad_index = nullptr )
+  {
+    out.joints.clear();
+    out.velocities.clear();
+    out.reserve( path.points.size() );
+    for ( size_t i = 0; i < path.points.size(); ++i ) {
+      const auto &p = path.points[ i ];
+      if ( p.joints.size() != kDof ) {
+        if ( bad_index ) { *bad_index = i; }
+        return false;
+      }
+      out.joints.insert( out.joints.end(), p.joints.begin(), p.joints.end() );
+      out.velocities.push_back( p.velocity );
+    }
+    return true;
+  }
+};
+
 struct PathCheck {
-  PathCheck *next = nullptr;
+  PathCheck *next             = nullptr;
+  DiagnosticRing *diagnostics = nullptr;  // 为空时诊断直接写到 std::cerr
 
   virtual bool check( const JointPath &path )
   {
@@ -31,57 +92,359 @@ struct PathCheck {
   virtual ~PathCheck() = default;
 };
 
+// 每个具体校验都提供三个非虚的钩子：
+//   checkPath  —— 针对整条路径的检查（如长度）
+//   accept     —— 针对单个路径点的纯判断，不输出任何信息
+//   checkPoint —— accept 失败时输出诊断信息
+// 虚函数 check 由这些钩子组成，供运行时链使用；CheckChain 则直接在编译期把它们内联在一起
 struct JointLengthCheck : PathCheck {
-  bool check( const JointPath &path ) override
+  bool checkPath( const JointPath &path ) const
   {
     if ( path.points.empty() ) {
-      std::cerr << "[Joint] path is empty\n";
+      report( diagnostics, { CheckError::EmptyPath, CheckId::Length, 0, 0.0 } );
       return false;
     }
+    return true;
+  }
+
+  bool accept( const JointPoint & ) const { return true; }
+  bool checkPoint( const JointPoint &, size_t ) const { return true; }
+
+  bool check( const JointPath &path ) override
+  {
+    if ( !checkPath( path ) ) { return false; }
     return PathCheck::check( path );
   }
 };
 
 struct JointDimensionCheck : PathCheck {
+  bool checkPath( const JointPath & ) const { return true; }
+
+  bool accept( const JointPoint &point ) const { return point.joints.size() == 6; }
+
+  bool checkPoint( const JointPoint &point, size_t i ) const
+  {
+    if ( !accept( point ) ) {
+      report( diagnostics,
+              { CheckError::BadDimension, CheckId::Dimension, i, static_cast<double>( point.joints.size() ) } );
+      return false;
+    }
+    return true;
+  }
+
   bool check( const JointPath &path ) override
   {
     for ( size_t i = 0; i < path.points.size(); ++i ) {
-      if ( path.points[ i ].joints.size() != 6 ) {
-        std::cerr << "[Joint] joint size != 6 at index " << i << "\n";
-        return false;
-      }
+      if ( !checkPoint( path.points[ i ], i ) ) { return false; }
     }
     return PathCheck::check( path );
   }
 };
 
 struct JointVelocityCheck : PathCheck {
+  bool checkPath( const JointPath & ) const { return true; }
+
+  bool accept( const JointPoint &point ) const { return !( point.velocity <= 0.0 ); }
+
+  bool checkPoint( const JointPoint &point, size_t i ) const
+  {
+    if ( !accept( point ) ) {
+      report( diagnostics, { CheckError::NonPositiveVelocity, CheckId::Velocity, i, point.velocity } );
+      return false;
+    }
+    return true;
+  }
+
   bool check( const JointPath &path ) override
   {
     for ( size_t i = 0; i < path.points.size(); ++i ) {
-      if ( path.points[ i ].velocity <= 0.0 ) {
-        std::cerr << "[Joint] velocity <= 0 at index " << i << "\n";
-        return false;
-      }
+      if ( !checkPoint( path.points[ i ], i ) ) { return false; }
+    }
+    return PathCheck::check( path );
+  }
+};
+
+struct JointLimitCheck : PathCheck {
+  JointLimits limits;
+
+  bool checkPath( const JointPath & ) const { return true; }
+
+  // 返回第一个越限的关节序号，没有则返回 6
+  size_t firstOutOfLimit( const double *joints, size_t count ) const
+  {
+    for ( size_t j = 0; j < count && j < 6; ++j ) {
+      if ( joints[ j ] < limits.lower[ j ] || joints[ j ] > limits.upper[ j ] ) { return j; }
+    }
+    return 6;
+  }
+
+  bool accept( const JointPoint &point ) const
+  {
+    return firstOutOfLimit( point.joints.data(), point.joints.size() ) == 6;
+  }
+
+  bool checkPoint( const JointPoint &point, size_t i ) const
+  {
+    const size_t j = firstOutOfLimit( point.joints.data(), point.joints.size() );
+    if ( j != 6 ) {
+      report( diagnostics, { CheckError::OutOfLimit, CheckId::Limit, i, point.joints[ j ] } );
+      return false;
+    }
+    return true;
+  }
+
+  bool check( const JointPath &path ) override
+  {
+    for ( size_t i = 0; i < path.points.size(); ++i ) {
+      if ( !checkPoint( path.points[ i ], i ) ) { return false; }
+    }
+    return PathCheck::check( path );
+  }
+};
+
+// 需要参考相邻点的“窗口”校验，例如速度连续性
+// 这类校验提供 acceptAt / checkAt( path, i )，并用 kLookback 声明需要向前看几个点
+struct JointVelocityContinuityCheck : PathCheck {
+  static constexpr size_t kLookback = 1;
+  double max_delta                  = std::numeric_limits<double>::infinity();  // 相邻两点速度差的上限
+
+  bool checkPath( const JointPath & ) const { return true; }
+
+  bool acceptAt( const JointPath &path, size_t i ) const
+  {
+    if ( i == 0 ) { return true; }
+    const double delta = path.points[ i ].velocity - path.points[ i - 1 ].velocity;
+    return !( delta > max_delta || -delta > max_delta );
+  }
+
+  bool checkAt( const JointPath &path, size_t i ) const
+  {
+    if ( !acceptAt( path, i ) ) {
+      const double delta = path.points[ i ].velocity - path.points[ i - 1 ].velocity;
+      report( diagnostics, { CheckError::VelocityJump, CheckId::VelocityContinuity, i, delta } );
+      return false;
+    }
+    return true;
+  }
+
+  bool check( const JointPath &path ) override
+  {
+    for ( size_t i = 0; i < path.points.size(); ++i ) {
+      if ( !checkAt( path, i ) ) { return false; }
     }
     return PathCheck::check( path );
   }
 };
 
+namespace detail
+{
+
+// 窗口校验走 acceptAt / checkAt，单点校验走 accept / checkPoint
+template <typename Check>
+bool acceptAt( const Check &c, const JointPath &path, size_t i )
+{
+  if constexpr ( requires { c.acceptAt( path, i ); } ) {
+    return c.acceptAt( path, i );
+  } else {
+    return c.accept( path.points[ i ] );
+  }
+}
+
+template <typename Check>
+bool checkAt( const Check &c, const JointPath &path, size_t i )
+{
+  if constexpr ( requires { c.checkAt( path, i ); } ) {
+    return c.checkAt( path, i );
+  } else {
+    return c.checkPoint( path.points[ i ], i );
+  }
+}
+
+template <typename Check>
+constexpr size_t lookback()
+{
+  if constexpr ( requires { Check::kLookback; } ) {
+    return Check::kLookback;
+  } else {
+    return 0;
+  }
+}
+
+}  // namespace detail
+
+// 编译期组装的责任链：没有 next 指针，也没有虚函数跳转
+// 先依次执行各校验的 checkPath，再在一次遍历中对每个点依次执行各校验的 checkPoint，任何一环失败立即返回
+// 与运行时链的区别：运行时链是“一个校验走完整条路径再交给下一个”，这里是“每个点走完整条链”，
+// 所以同时存在多种错误时报告的可能是另一处错误，但通过/失败的结论相同
+template <typename... Checks>
+class CheckChain
+{
+ public:
+  bool check( const JointPath &path ) const
+  {
+    if ( !checkPath( path ) ) { return false; }
+
+    for ( size_t i = 0; i < path.points.size(); ++i ) {
+      if ( !checkPoint( path, i ) ) { return false; }
+    }
+    return true;
+  }
+
+  // 链上所有窗口校验中最大的回看点数：修改第 i 个点会影响 [i, i + lookback] 的校验结果
+  static constexpr size_t lookback() { return std::max( { size_t( 0 ), detail::lookback<Checks>()... } ); }
+
+  // 只对整条路径执行 checkPath（输出诊断）
+  bool checkPath( const JointPath &path ) const
+  {
+    return std::apply( [ &path ]( const auto &...c ) { return ( c.checkPath( path ) && ... ); }, checks_ );
+  }
+
+  // 对第 i 个点执行整条链的检查（输出诊断）
+  bool checkPoint( const JointPath &path, size_t i ) const
+  {
+    return std::apply( [ &path, i ]( const auto &...c ) { return ( detail::checkAt( c, path, i ) && ... ); },
+                       checks_ );
+  }
+
+  // 在 [begin, end) 中查找第一个没有通过整条链的点，不输出诊断；全部通过时返回 end
+  size_t findFirstFailure( const JointPath &path, size_t begin, size_t end ) const
+  {
+    for ( size_t i = begin; i < end; ++i ) {
+      if ( !std::apply( [ &path, i ]( const auto &...c ) { return ( detail::acceptAt( c, path, i ) && ... ); },
+                        checks_ ) ) {
+        return i;
+      }
+    }
+    return end;
+  }
+
+  // 让链上所有校验都把诊断写到同一个环里
+  void setDiagnostics( DiagnosticRing *ring )
+  {
+    std::apply( [ ring ]( auto &...c ) { ( ( c.diagnostics = ring ), ... ); }, checks_ );
+  }
+
+  // 取出链上的某个校验，用于配置参数（如限位）
+  template <typename Check>
+  Check &get()
+  {
+    return std::get<Check>( checks_ );
+  }
+
+ private:
+  std::tuple<Checks...> checks_;
+};
+
+using JointCheckChain = CheckChain<JointLengthCheck, JointDimensionCheck, JointVelocityCheck>;
+
+// SoA 路径的批量校验内核
+// 按块处理，块内循环不提前退出，只做无分支的“或”累积，便于编译器自动向量化（AVX2 / NEON）；
+// 只有某一块出错时才回头逐点定位第一个出错的下标
+namespace SoAKernels
+{
+
+constexpr size_t kBlock = 256;
+
+// 返回第一个速度 <= 0 的下标，没有则返回 n
+inline size_t firstNonPositive( const double *v, size_t n )
+{
+  for ( size_t base = 0; base < n; base += kBlock ) {
+    const size_t end = base + kBlock < n ? base + kBlock : n;
+    bool bad         = false;
+    for ( size_t i = base; i < end; ++i ) { bad |= v[ i ] <= 0.0; }
+    if ( bad ) {
+      for ( size_t i = base; i < end; ++i ) {
+        if ( v[ i ] <= 0.0 ) { return i; }
+      }
+    }
+  }
+  return n;
+}
+
+// 返回第一个关节越限的点的下标，没有则返回 n
+inline size_t firstOutOfLimit( const double *q, size_t n, const JointLimits &limits )
+{
+  constexpr size_t dof = JointPathSoA::kDof;
+  for ( size_t base = 0; base < n; base += kBlock ) {
+    const size_t end = base + kBlock < n ? base + kBlock : n;
+    bool bad         = false;
+    for ( size_t i = base * dof; i < end * dof; i += dof ) {
+      for ( size_t j = 0; j < dof; ++j ) {
+        bad |= ( q[ i + j ] < limits.lower[ j ] ) | ( q[ i + j ] > limits.upper[ j ] );
+      }
+    }
+    if ( bad ) {
+      for ( size_t i = base; i < end; ++i ) {
+        for ( size_t j = 0; j < dof; ++j ) {
+          if ( q[ i * dof + j ] < limits.lower[ j ] || q[ i * dof + j ] > limits.upper[ j ] ) { return i; }
+        }
+      }
+    }
+  }
+  return n;
+}
+
+}  // namespace SoAKernels
+
 // 这里封装一个校验类
 struct Planner {
-  bool validateJoint( const JointPath &path )
+  // 使用编译期链，链对象随 Planner 创建一次，之后反复使用
+  bool validateJoint( const JointPath &path ) { return jointChain.check( path ); }
+
+  // 设置诊断输出的环，为空时退回 std::cerr
+  void setDiagnostics( DiagnosticRing *ring )
   {
-    JointLengthCheck len;
-    JointDimensionCheck dim;
-    JointVelocityCheck vel;
+    diagnostics = ring;
+    jointChain.setDiagnostics( ring );
+  }
 
-    len.next = &dim;
-    dim.next = &vel;
+  // SoA 版本：长度、维度、速度、限位在一次遍历中完成
+  // 结果与 JointLengthCheck -> JointDimensionCheck -> JointVelocityCheck -> JointLimitCheck 链一致
+  bool validateJoint( const JointPathSoA &path, const JointLimits &limits = {} )
+  {
+    const size_t n = path.size();
+    if ( n == 0 ) {
+      report( diagnostics, { CheckError::EmptyPath, CheckId::Length, 0, 0.0 } );
+      return false;
+    }
+    if ( path.joints.size() != n * JointPathSoA::kDof ) {
+      report( diagnostics,
+              { CheckError::BadBufferSize, CheckId::Dimension, n, static_cast<double>( path.joints.size() ) } );
+      return false;
+    }
 
-    return len.check( path );
+    // 链中速度检查排在限位检查之前：任何速度错误都优先报告，限位错误只记录第一个
+    const double *q  = path.joints.data();
+    const double *v  = path.velocities.data();
+    size_t first_lim = n;
+    for ( size_t base = 0; base < n; base += SoAKernels::kBlock ) {
+      const size_t count = base + SoAKernels::kBlock < n ? SoAKernels::kBlock : n - base;
+      const size_t vel   = SoAKernels::firstNonPositive( v + base, count );
+      if ( vel != count ) {
+        report( diagnostics, { CheckError::NonPositiveVelocity, CheckId::Velocity, base + vel, v[ base + vel ] } );
+        return false;
+      }
+      if ( first_lim == n ) {
+        const size_t lim = SoAKernels::firstOutOfLimit( q + base * JointPathSoA::kDof, count, limits );
+        if ( lim != count ) { first_lim = base + lim; }
+      }
+    }
+    if ( first_lim != n ) {
+      const double *point = q + first_lim * JointPathSoA::kDof;
+      size_t j            = 0;
+      while ( j + 1 < JointPathSoA::kDof && !( point[ j ] < limits.lower[ j ] || point[ j ] > limits.upper[ j ] ) ) {
+        ++j;
+      }
+      report( diagnostics, { CheckError::OutOfLimit, CheckId::Limit, first_lim, point[ j ] } );
+      return false;
+    }
+    return true;
   }
+
+ private:
+  JointCheckChain jointChain;
+  DiagnosticRing *diagnostics = nullptr;
 };
 }  // namespace DesignPatterns::ResponsibilityChain
 
-#endif
\ No newline at end of file
+#endif
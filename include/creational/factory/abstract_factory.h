@@ -1,11 +1,12 @@
 #ifndef DESIGN_PATTERNS_FACTORY_ABSTRACT_FACTORY_H
 #define DESIGN_PATTERNS_FACTORY_ABSTRACT_FACTORY_H
 
-#include <iostream>
 #include <memory>
 #include <vector>
 #include <map>
 
+#include "creational/singleton/logger.h"
+
 namespace DesignPatterns::Factory
 {
 
@@ -18,13 +19,13 @@ class Drink
 class Tea : public Drink
 {
  public:
-  void prepare( int volume ) override { std::cout << "Tea " << volume << "ml\n" << std::endl; }
+  void prepare( int volume ) override { Singleton::log_info( "Tea ", volume, "ml\n" ); }
 };
 
 class Coffee : public Drink
 {
  public:
-  void prepare( int volume ) override { std::cout << "Coffee " << volume << "ml\n" << std::endl; }
+  void prepare( int volume ) override { Singleton::log_info( "Coffee ", volume, "ml\n" ); }
 };
 
 /// 定义抽象工厂类
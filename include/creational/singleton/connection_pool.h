@@ -0,0 +1,385 @@
+#ifndef DESIGN_PATTERNS_SINGLETON_CONNECTION_POOL_H
+#define DESIGN_PATTERNS_SINGLETON_CONNECTION_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "creational/singleton/latency_histogram.h"
+
+namespace DesignPatterns::Singleton
+{
+
+// 绑定了参数的预备语句
+struct BoundStatement {
+  uint64_t statement;               // prepare() 返回的编号
+  std::vector<std::string> params;  // 按顺序替换语句中的 '?'
+};
+
+// 数据库连接
+class Connection
+{
+ public:
+  virtual ~Connection() = default;
+
+  virtual std::string execute( const std::string &query ) = 0;
+
+  // 在服务端解析语句，返回只在这个连接上有效的编号
+  virtual uint64_t prepare( const std::string &sql ) = 0;
+
+  // 一次往返执行多条预备语句，结果与逐条 execute 相同
+  virtual std::vector<std::string> execute_batch( const std::vector<BoundStatement> &batch ) = 0;
+};
+
+// 假后端的耗时模型：往返时间用睡眠模拟，不占用客户端的 CPU；解析和执行用忙等模拟
+struct FakeBackendCosts {
+  std::chrono::nanoseconds round_trip{ 0 };
+  std::chrono::nanoseconds parse{ 0 };    // 每次解析一条 SQL
+  std::chrono::nanoseconds execute{ 0 };  // 每执行一条语句
+};
+
+// 进程内的假后端，供测试和基准测试使用
+class FakeConnection : public Connection
+{
+ public:
+  FakeConnection( size_t id, std::string connection_string, FakeBackendCosts costs = {} )
+      : id_( id ), connection_string_( std::move( connection_string ) ), costs_( costs )
+  {
+  }
+
+  std::string execute( const std::string &query ) override
+  {
+    wait( costs_.round_trip );
+    spin( costs_.parse + costs_.execute );
+    return result( query );
+  }
+
+  uint64_t prepare( const std::string &sql ) override
+  {
+    wait( costs_.round_trip );
+    spin( costs_.parse );
+    statements_.push_back( sql );
+    return statements_.size() - 1;
+  }
+
+  std::vector<std::string> execute_batch( const std::vector<BoundStatement> &batch ) override
+  {
+    wait( costs_.round_trip );
+    std::vector<std::string> results;
+    results.reserve( batch.size() );
+    for ( const auto &bound : batch ) {
+      if ( bound.statement >= statements_.size() ) { throw std::runtime_error( "FakeConnection: unknown statement" ); }
+      spin( costs_.execute );
+      // 把参数填回语句，得到与直接执行原始查询相同的结果
+      const std::string &sql = statements_[ bound.statement ];
+      std::string query;
+      size_t next = 0;
+      for ( char c : sql ) {
+        if ( c == '?' && next < bound.params.size() ) {
+          query += bound.params[ next++ ];
+        } else {
+          query += c;
+        }
+      }
+      results.push_back( result( query ) );
+    }
+    return results;
+  }
+
+  size_t id() const { return id_; }
+  const std::string &connection_string() const { return connection_string_; }
+  size_t queries() const { return queries_; }
+  size_t prepared() const { return statements_.size(); }
+
+ private:
+  static void wait( std::chrono::nanoseconds duration )
+  {
+    if ( duration.count() > 0 ) { std::this_thread::sleep_for( duration ); }
+  }
+
+  static void spin( std::chrono::nanoseconds duration )
+  {
+    if ( duration.count() > 0 ) {
+      const auto until = std::chrono::steady_clock::now() + duration;
+      while ( std::chrono::steady_clock::now() < until ) {}
+    }
+  }
+
+  std::string result( const std::string &query )
+  {
+    ++queries_;
+    return "conn#" + std::to_string( id_ ) + " OK: " + query;
+  }
+
+  size_t id_;
+  std::string connection_string_;
+  FakeBackendCosts costs_;
+  std::vector<std::string> statements_;
+  size_t queries_ = 0;
+};
+
+// 参数为连接在池中的编号
+using ConnectionFactory = std::function<std::unique_ptr<Connection>( size_t id )>;
+
+struct PoolOptions {
+  size_t max_size                            = 16;  // 最多同时存在的连接数，全部借出后新的请求排队等待
+  std::chrono::milliseconds checkout_timeout = std::chrono::milliseconds( 1000 );
+};
+
+struct PoolStats {
+  uint64_t checkouts = 0;
+  uint64_t timeouts  = 0;
+  size_t created     = 0;  // 已经建立的连接
+  size_t in_use      = 0;
+  size_t peak_in_use = 0;
+  uint64_t p50_ns    = 0;  // 借出连接所用的时间，包括排队等待
+  uint64_t p99_ns    = 0;
+  double utilization = 0;  // 连接被借出的时间占 max_size × 统计时长 的比例
+};
+
+class PoolTimeout : public std::runtime_error
+{
+ public:
+  PoolTimeout() : std::runtime_error( "ConnectionPool: checkout timed out" ) {}
+};
+
+// 连接池
+// 空闲连接放在一个无锁的栈里（Treiber 栈，栈顶带版本号防止 ABA），借出和归还只用 CAS。
+// 每个线程记住自己上次用过的连接，下次优先直接拿回它，连接的状态由槽位上的原子变量决定，
+// 栈里的条目只是提示，弹出时发现已经被别人拿走就丢弃。连接按需创建，达到 max_size 后借用者在条件变量上等待，
+// 超时返回空或抛出 PoolTimeout
+class ConnectionPool
+{
+  struct alignas( 64 ) Slot {
+    std::unique_ptr<Connection> connection;
+    std::atomic<bool> busy{ true };       // 借出中，或者还没有建立连接
+    std::atomic<bool> in_stack{ false };  // 栈中有这个槽位的条目
+    std::atomic<uint32_t> next{ kNone };  // 栈中的下一个槽位
+    std::chrono::steady_clock::time_point leased_at;
+  };
+
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+ public:
+  // 借出的连接，析构时归还
+  class Lease
+  {
+   public:
+    Lease( Lease &&other ) noexcept
+        : pool_( std::exchange( other.pool_, nullptr ) ), slot_( other.slot_ )
+    {
+    }
+    Lease( const Lease & )            = delete;
+    Lease &operator=( const Lease & ) = delete;
+    Lease &operator=( Lease && )      = delete;
+
+    ~Lease()
+    {
+      if ( pool_ ) { pool_->release( slot_ ); }
+    }
+
+    Connection &operator*() const { return *pool_->slots_[ slot_ ].connection; }
+    Connection *operator->() const { return pool_->slots_[ slot_ ].connection.get(); }
+    size_t id() const { return slot_; }
+
+   private:
+    friend class ConnectionPool;
+
+    Lease( ConnectionPool *pool, uint32_t slot ) : pool_( pool ), slot_( slot ) {}
+
+    ConnectionPool *pool_;
+    uint32_t slot_;
+  };
+
+  ConnectionPool( ConnectionFactory factory, PoolOptions options = {} )
+      : factory_( std::move( factory ) ), options_( options ),
+        slots_( std::max<size_t>( options_.max_size, 1 ) ), since_( std::chrono::steady_clock::now() )
+  {
+    options_.max_size = slots_.size();
+  }
+
+  ConnectionPool( const ConnectionPool & )            = delete;
+  ConnectionPool &operator=( const ConnectionPool & ) = delete;
+
+  // 借出一个连接，等待超过 checkout_timeout 时抛出 PoolTimeout
+  Lease checkout()
+  {
+    if ( auto lease = try_checkout( options_.checkout_timeout ) ) { return std::move( *lease ); }
+    throw PoolTimeout();
+  }
+
+  std::optional<Lease> try_checkout( std::chrono::nanoseconds timeout )
+  {
+    const auto start = std::chrono::steady_clock::now();
+    uint32_t slot    = acquire();
+    if ( slot == kNone ) {
+      std::unique_lock<std::mutex> lock( wait_mutex_ );
+      waiters_.fetch_add( 1 );
+      ready_.wait_for( lock, timeout, [ this, &slot ]() { return ( slot = acquire() ) != kNone; } );
+      waiters_.fetch_sub( 1 );
+      if ( slot == kNone ) {
+        timeouts_.fetch_add( 1, std::memory_order_relaxed );
+        return std::nullopt;
+      }
+    }
+    if ( !slots_[ slot ].connection ) {  // 新的槽位，或者上次建立连接失败的槽位
+      try {
+        slots_[ slot ].connection = factory_( slot );
+      } catch ( ... ) {
+        give_back( slot );
+        throw;
+      }
+      connected_.fetch_add( 1, std::memory_order_relaxed );
+    }
+    const auto now = std::chrono::steady_clock::now();
+    histogram_.record(
+        static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( now - start ).count() ) );
+    slots_[ slot ].leased_at = now;
+    affinity().pool          = this;
+    affinity().slot          = slot;
+    const size_t in_use      = in_use_.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    size_t peak              = peak_in_use_.load( std::memory_order_relaxed );
+    while ( in_use > peak && !peak_in_use_.compare_exchange_weak( peak, in_use, std::memory_order_relaxed ) ) {}
+    return Lease( this, slot );
+  }
+
+  size_t max_size() const { return options_.max_size; }
+
+  PoolStats stats() const
+  {
+    PoolStats s;
+    s.timeouts    = timeouts_.load();
+    s.created     = connected_.load();
+    s.in_use      = in_use_.load();
+    s.peak_in_use = peak_in_use_.load();
+    const auto latencies = histogram_.snapshot();
+    s.checkouts          = latencies.total;
+    s.p50_ns             = latencies.percentile( 0.5 );
+    s.p99_ns             = latencies.percentile( 0.99 );
+
+    const double elapsed =
+        std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - since_ ).count();
+    s.utilization = elapsed > 0 ? static_cast<double>( busy_ns_.load() ) / ( elapsed * options_.max_size ) : 0;
+    return s;
+  }
+
+  // 清空统计，已经建立的连接不受影响；不要与 stats() 并发调用
+  void reset_stats()
+  {
+    histogram_.reset();
+    timeouts_.store( 0 );
+    busy_ns_.store( 0 );
+    peak_in_use_.store( in_use_.load() );
+    since_ = std::chrono::steady_clock::now();
+  }
+
+ private:
+  struct Affinity {
+    const ConnectionPool *pool = nullptr;
+    uint32_t slot              = kNone;
+  };
+
+  static Affinity &affinity()
+  {
+    thread_local Affinity cached;
+    return cached;
+  }
+
+  uint32_t acquire()
+  {
+    // 1. 上次用过的连接
+    const Affinity &cached = affinity();
+    if ( cached.pool == this && cached.slot < slots_.size() && claim( cached.slot ) ) { return cached.slot; }
+    // 2. 空闲栈
+    for ( uint32_t slot = pop(); slot != kNone; slot = pop() ) {
+      if ( claim( slot ) ) { return slot; }
+    }
+    // 3. 还没达到上限就占用一个新槽位，由调用方建立连接
+    size_t reserved = reserved_.load();
+    while ( reserved < slots_.size() ) {
+      if ( reserved_.compare_exchange_weak( reserved, reserved + 1 ) ) { return static_cast<uint32_t>( reserved ); }
+    }
+    return kNone;
+  }
+
+  bool claim( uint32_t slot ) { return !slots_[ slot ].busy.exchange( true ); }
+
+  void release( uint32_t slot )
+  {
+    Slot &s = slots_[ slot ];
+    busy_ns_.fetch_add( static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                   std::chrono::steady_clock::now() - s.leased_at )
+                                                   .count() ),
+                        std::memory_order_relaxed );
+    in_use_.fetch_sub( 1, std::memory_order_relaxed );
+    give_back( slot );
+  }
+
+  void give_back( uint32_t slot )
+  {
+    Slot &s = slots_[ slot ];
+    s.busy.store( false );
+    // 栈里已经有它的条目（可能正被弹出）时不再压栈，弹出它的线程会重新检查 busy
+    if ( !s.in_stack.exchange( true ) ) { push( slot ); }
+    if ( waiters_.load() > 0 ) {
+      std::lock_guard<std::mutex> lock( wait_mutex_ );
+      ready_.notify_one();
+    }
+  }
+
+  // 栈顶：低 32 位为槽位，高 32 位为版本号
+  void push( uint32_t slot )
+  {
+    uint64_t head = head_.load();
+    do {
+      slots_[ slot ].next.store( static_cast<uint32_t>( head ) );
+    } while ( !head_.compare_exchange_weak( head, ( ( head >> 32 ) + 1 ) << 32 | slot ) );
+  }
+
+  uint32_t pop()
+  {
+    uint64_t head = head_.load();
+    for ( ;; ) {
+      const auto slot = static_cast<uint32_t>( head );
+      if ( slot == kNone ) { return kNone; }
+      // 槽位永远不会被释放，即使已经被别人弹出，读 next 也是安全的，版本号保证 CAS 不会误判
+      const uint32_t next = slots_[ slot ].next.load();
+      if ( head_.compare_exchange_weak( head, ( ( head >> 32 ) + 1 ) << 32 | next ) ) {
+        slots_[ slot ].in_stack.store( false );
+        return slot;
+      }
+    }
+  }
+
+  ConnectionFactory factory_;
+  PoolOptions options_;
+  std::vector<Slot> slots_;
+  alignas( 64 ) std::atomic<uint64_t> head_{ kNone };
+  alignas( 64 ) std::atomic<size_t> reserved_{ 0 };  // 已经分配出去的槽位
+  std::atomic<size_t> connected_{ 0 };
+  std::atomic<size_t> in_use_{ 0 };
+  std::atomic<size_t> peak_in_use_{ 0 };
+  std::atomic<size_t> waiters_{ 0 };
+  std::atomic<uint64_t> timeouts_{ 0 };
+  std::atomic<uint64_t> busy_ns_{ 0 };
+  LatencyHistogram histogram_;  // 取连接的等待时间
+  std::chrono::steady_clock::time_point since_;
+  std::mutex wait_mutex_;
+  std::condition_variable ready_;
+};
+
+}  // namespace DesignPatterns::Singleton
+
+#endif  // DESIGN_PATTERNS_SINGLETON_CONNECTION_POOL_H
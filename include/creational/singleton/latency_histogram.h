@@ -0,0 +1,88 @@
+#ifndef DESIGN_PATTERNS_SINGLETON_LATENCY_HISTOGRAM_H
+#define DESIGN_PATTERNS_SINGLETON_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace DesignPatterns::Singleton
+{
+
+// 对数分桶的延迟直方图：每个 2 的幂区间再分成 8 份，分位数误差不超过 12.5%。
+// 大小固定，记录时不分配内存；ConnectionPool 和 Command::CommandExecutor 共用
+class LatencyHistogram
+{
+ public:
+  static constexpr size_t kSubBuckets = 8;
+  static constexpr size_t kBuckets    = 64 * kSubBuckets;
+
+  // 某一时刻各个桶的计数
+  struct Snapshot {
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t total = 0;
+
+    // 第 q 分位所在桶的下界，没有样本时返回 0
+    uint64_t percentile( double q ) const
+    {
+      if ( total == 0 ) { return 0; }
+      const auto rank = static_cast<uint64_t>( q * static_cast<double>( total - 1 ) );
+      uint64_t seen   = 0;
+      for ( size_t b = 0; b < kBuckets; ++b ) {
+        seen += counts[ b ];
+        if ( seen > rank ) { return bucket_floor( b ); }
+      }
+      return bucket_floor( kBuckets - 1 );
+    }
+  };
+
+  static size_t bucket_of( uint64_t ns )
+  {
+    if ( ns < kSubBuckets ) { return static_cast<size_t>( ns ); }
+    const int exponent = std::bit_width( ns ) - 1;  // >= 3
+    const auto sub     = static_cast<size_t>( ( ns >> ( exponent - 3 ) ) & ( kSubBuckets - 1 ) );
+    return static_cast<size_t>( exponent - 2 ) * kSubBuckets + sub;
+  }
+
+  // 桶的下界
+  static uint64_t bucket_floor( size_t bucket )
+  {
+    if ( bucket < kSubBuckets ) { return bucket; }
+    const size_t exponent = bucket / kSubBuckets + 2;
+    return ( uint64_t( kSubBuckets ) | ( bucket % kSubBuckets ) ) << ( exponent - 3 );
+  }
+
+  // 任意线程都可以调用
+  void record( uint64_t ns ) { buckets_[ bucket_of( ns ) ].fetch_add( 1, std::memory_order_relaxed ); }
+
+  // 只有一个线程写入时用 load + store 代替原子加法
+  void record_single_writer( uint64_t ns )
+  {
+    auto &bucket = buckets_[ bucket_of( ns ) ];
+    bucket.store( bucket.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+  }
+
+  // 可以与 record 并发调用，得到的是近似的一致视图
+  Snapshot snapshot() const
+  {
+    Snapshot s;
+    for ( size_t b = 0; b < kBuckets; ++b ) {
+      s.counts[ b ] = buckets_[ b ].load( std::memory_order_relaxed );
+      s.total += s.counts[ b ];
+    }
+    return s;
+  }
+
+  void reset()
+  {
+    for ( auto &bucket : buckets_ ) { bucket.store( 0, std::memory_order_relaxed ); }
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+};
+
+}  // namespace DesignPatterns::Singleton
+
+#endif  // DESIGN_PATTERNS_SINGLETON_LATENCY_HISTOGRAM_H
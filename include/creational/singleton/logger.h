@@ -0,0 +1,430 @@
+#ifndef DESIGN_PATTERNS_SINGLETON_LOGGER_H
+#define DESIGN_PATTERNS_SINGLETON_LOGGER_H
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 编译期日志级别：低于它的日志调用整个被编译掉。0 Debug，1 Info，2 Warn，3 Error，4 全部关闭
+#ifndef DESIGN_PATTERNS_LOG_LEVEL
+#define DESIGN_PATTERNS_LOG_LEVEL 1
+#endif
+
+namespace DesignPatterns::Singleton
+{
+
+enum class LogLevel { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>( DESIGN_PATTERNS_LOG_LEVEL );
+
+namespace detail
+{
+
+// 参数在记录里的存储类型：字符串按长度加内容复制，非字符指针只记地址，其余算术类型按值复制
+template <typename T>
+using log_arg_t = std::conditional_t<
+    std::is_convertible_v<const T &, std::string_view>, std::string_view,
+    std::conditional_t<std::is_pointer_v<std::decay_t<T>>, const void *, std::decay_t<T>>>;
+
+template <typename T>
+size_t encoded_size( const T &value )
+{
+  if constexpr ( std::is_same_v<T, std::string_view> ) {
+    return sizeof( uint32_t ) + value.size();
+  } else {
+    static_assert( std::is_arithmetic_v<T> || std::is_same_v<T, const void *>, "unsupported log argument type" );
+    return sizeof( T );
+  }
+}
+
+template <typename T>
+char *encode( char *out, const T &value )
+{
+  if constexpr ( std::is_same_v<T, std::string_view> ) {
+    const auto length = static_cast<uint32_t>( value.size() );
+    std::memcpy( out, &length, sizeof( length ) );
+    std::memcpy( out + sizeof( length ), value.data(), length );
+    return out + sizeof( length ) + length;
+  } else {
+    std::memcpy( out, &value, sizeof( T ) );
+    return out + sizeof( T );
+  }
+}
+
+// 与 std::ostream 默认格式相同：浮点数 6 位有效数字，bool 输出 1 / 0，指针输出十六进制地址
+template <typename T>
+const char *decode( const char *in, std::string &out )
+{
+  if constexpr ( std::is_same_v<T, std::string_view> ) {
+    uint32_t length;
+    std::memcpy( &length, in, sizeof( length ) );
+    out.append( in + sizeof( length ), length );
+    return in + sizeof( length ) + length;
+  } else {
+    T value;
+    std::memcpy( &value, in, sizeof( T ) );
+    char digits[ 64 ];
+    char *end = digits;
+    if constexpr ( std::is_same_v<T, char> ) {
+      *end++ = value;
+    } else if constexpr ( std::is_same_v<T, bool> ) {
+      *end++ = value ? '1' : '0';
+    } else if constexpr ( std::is_same_v<T, const void *> ) {
+      if ( value ) {
+        *end++ = '0';
+        *end++ = 'x';
+        end    = std::to_chars( end, digits + sizeof( digits ), reinterpret_cast<uintptr_t>( value ), 16 ).ptr;
+      } else {
+        *end++ = '0';
+      }
+    } else if constexpr ( std::is_floating_point_v<T> ) {
+      end = std::to_chars( digits, digits + sizeof( digits ), value, std::chars_format::general, 6 ).ptr;
+    } else {
+      end = std::to_chars( digits, digits + sizeof( digits ), value ).ptr;
+    }
+    out.append( digits, end );
+    return in + sizeof( T );
+  }
+}
+
+// 在后台线程上把一条记录的参数格式化成一行
+template <typename... Args>
+void format_record( const char *in, std::string &out )
+{
+  ( ( in = decode<Args>( in, out ) ), ... );
+  out += '\n';
+}
+
+}  // namespace detail
+
+// 异步日志
+// 每个线程第一次写日志时得到一块自己的环形缓冲区（单生产者单消费者，无锁），日志调用只把参数的二进制值
+// 连同格式化函数的指针写进缓冲区；后台线程定期把所有缓冲区里的记录格式化成文本，再用一次 writev 写出去。
+// 同一线程的日志保持顺序，不同线程之间不保证先后。缓冲区写满时调用方等待后台线程腾出空间，日志不会丢失
+class Logger
+{
+  using FormatFn = void ( * )( const char *, std::string & );
+
+  struct RecordHeader {
+    uint32_t size;  // 包括记录头，按 8 字节对齐；format 为空表示跳到缓冲区开头
+    FormatFn format;
+  };
+  static_assert( sizeof( RecordHeader ) == 16 );
+
+  struct alignas( 64 ) ThreadBuffer {
+    explicit ThreadBuffer( size_t capacity ) : data( new char[ capacity ] ), capacity( capacity ) {}
+
+    std::unique_ptr<char[]> data;
+    size_t capacity;
+    alignas( 64 ) std::atomic<uint64_t> head{ 0 };  // 生产者写到的位置
+    uint64_t cached_tail = 0;                       // 生产者看到的消费位置，减少读 tail 的次数
+    alignas( 64 ) std::atomic<uint64_t> tail{ 0 };  // 后台线程读到的位置
+    std::atomic<bool> retired{ false };             // 所属线程已经退出
+    std::string text;                               // 后台线程格式化后等待写出的文本
+  };
+
+ public:
+  static constexpr size_t kBufferBytes = size_t( 1 ) << 18;  // 每个线程的缓冲区大小
+
+  static Logger &get_instance()
+  {
+    static Logger instance;
+    return instance;
+  }
+
+  template <LogLevel Level, typename... Args>
+  void log( const Args &...args )
+  {
+    if constexpr ( Level >= kCompiledLogLevel && Level != LogLevel::Off ) {
+      write<detail::log_arg_t<Args>...>( detail::log_arg_t<Args>( args )... );
+    }
+  }
+
+  // 等待调用之前写入的日志全部写出；后台线程已经停止时由调用方自己写出
+  void flush()
+  {
+    std::unique_lock<std::mutex> lock( flush_mutex_ );
+    if ( stopped_.load() ) {
+      lock.unlock();
+      drain();
+      return;
+    }
+    const uint64_t target = ++flush_requested_;
+    wake_.notify_all();
+    flushed_.wait( lock, [ this, target ]() { return flush_done_ >= target; } );
+  }
+
+  // 改为写入 fd，之前的日志先写到原来的位置
+  void set_output( int fd )
+  {
+    flush();
+    fd_.store( fd );
+  }
+
+  int output() const { return fd_.load(); }
+
+  // 缓冲区写满、调用方不得不等待的次数
+  uint64_t stalls() const { return stalls_.load( std::memory_order_relaxed ); }
+
+ private:
+  Logger()
+  {
+    flusher_ = std::jthread( [ this ]( std::stop_token token ) { run( token ); } );
+  }
+
+  ~Logger()
+  {
+    flusher_.request_stop();
+    wake_.notify_all();
+    flusher_.join();  // 之后 flush 和写满的缓冲区都由调用方自己写出
+    drain();          // 停止后才写入的日志
+  }
+
+  Logger( const Logger & )            = delete;
+  Logger &operator=( const Logger & ) = delete;
+
+  template <typename... Args>
+  void write( const Args &...args )
+  {
+    const size_t payload = ( detail::encoded_size( args ) + ... + 0 );
+    const size_t size    = ( sizeof( RecordHeader ) + payload + 7 ) & ~size_t( 7 );
+    ThreadBuffer &buffer = local_buffer();
+    if ( size > buffer.capacity / 4 ) {
+      // 超长的记录不经过缓冲区，在调用方格式化；先写出本线程之前的记录，并与后台线程的写出互斥，保证顺序
+      std::vector<char> encoded( payload );
+      char *out = encoded.data();
+      ( ( out = detail::encode( out, args ) ), ... );
+      std::string text;
+      detail::format_record<Args...>( encoded.data(), text );
+      std::lock_guard<std::mutex> lock( drain_mutex_ );
+      drain_locked();
+      write_all( fd_.load(), text );
+      return;
+    }
+    char *out = reserve( buffer, size );
+    const RecordHeader header{ static_cast<uint32_t>( size ), &detail::format_record<Args...> };
+    std::memcpy( out, &header, sizeof( header ) );
+    out += sizeof( header );
+    ( ( out = detail::encode( out, args ) ), ... );
+    buffer.head.store( buffer.head.load( std::memory_order_relaxed ) + size, std::memory_order_release );
+  }
+
+  // 在缓冲区里找一段连续的 size 字节；剩下的尾部放不下时写一个跳转记录，从头开始
+  char *reserve( ThreadBuffer &buffer, size_t size )
+  {
+    uint64_t head       = buffer.head.load( std::memory_order_relaxed );
+    const size_t offset = head % buffer.capacity;
+    const size_t skip   = buffer.capacity - offset < size ? buffer.capacity - offset : 0;
+    while ( head + skip + size - buffer.cached_tail > buffer.capacity ) {
+      buffer.cached_tail = buffer.tail.load( std::memory_order_acquire );
+      if ( head + skip + size - buffer.cached_tail <= buffer.capacity ) { break; }
+      stalls_.fetch_add( 1, std::memory_order_relaxed );
+      if ( stopped_.load() ) {  // 后台线程已经退出，自己腾出空间
+        drain();
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> lock( flush_mutex_ );  // 立即唤醒后台线程，不等下一个写出周期
+        drain_requested_ = true;
+      }
+      wake_.notify_one();
+      std::this_thread::yield();
+    }
+    if ( skip > 0 ) {
+      if ( skip >= sizeof( RecordHeader ) ) {
+        const RecordHeader wrap{ static_cast<uint32_t>( skip ), nullptr };
+        std::memcpy( buffer.data.get() + offset, &wrap, sizeof( wrap ) );
+      }
+      head += skip;
+      buffer.head.store( head, std::memory_order_release );
+    }
+    return buffer.data.get() + head % buffer.capacity;
+  }
+
+  ThreadBuffer &local_buffer()
+  {
+    // 线程退出时标记缓冲区，后台线程写完剩下的记录后把它移除
+    struct Holder {
+      std::shared_ptr<ThreadBuffer> buffer;
+      ~Holder()
+      {
+        if ( buffer ) { buffer->retired.store( true, std::memory_order_release ); }
+      }
+    };
+    thread_local Holder holder;
+    if ( !holder.buffer ) {
+      holder.buffer = std::make_shared<ThreadBuffer>( kBufferBytes );
+      std::lock_guard<std::mutex> lock( buffers_mutex_ );
+      buffers_.push_back( holder.buffer );
+    }
+    return *holder.buffer;
+  }
+
+  void run( std::stop_token token )
+  {
+    for ( ;; ) {
+      uint64_t requested;
+      {
+        std::unique_lock<std::mutex> lock( flush_mutex_ );
+        wake_.wait_for( lock, token, kFlushInterval,
+                        [ this ]() { return drain_requested_ || flush_requested_ > flush_done_; } );
+        if ( token.stop_requested() ) { break; }
+        requested        = flush_requested_;
+        drain_requested_ = false;
+      }
+      drain();
+      {
+        std::lock_guard<std::mutex> lock( flush_mutex_ );
+        flush_done_ = std::max( flush_done_, requested );
+      }
+      flushed_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock( flush_mutex_ );
+    stopped_.store( true );
+    flush_done_ = flush_requested_;
+    flushed_.notify_all();
+  }
+
+  void drain()
+  {
+    std::lock_guard<std::mutex> lock( drain_mutex_ );
+    drain_locked();
+  }
+
+  // 把所有缓冲区中已经提交的记录格式化，再一起写出；调用方持有 drain_mutex_，同一时刻只有一个消费者
+  void drain_locked()
+  {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+      std::lock_guard<std::mutex> lock( buffers_mutex_ );
+      // 先读 retired 再读 head：线程退出前写入的记录一定能在这一轮被看到
+      std::erase_if( buffers_, []( const auto &b ) {
+        return b->retired.load( std::memory_order_acquire ) &&
+               b->tail.load( std::memory_order_relaxed ) == b->head.load( std::memory_order_acquire );
+      } );
+      buffers = buffers_;
+    }
+    std::vector<iovec> iov;
+    for ( auto &buffer : buffers ) {
+      buffer->text.clear();
+      const uint64_t head = buffer->head.load( std::memory_order_acquire );
+      uint64_t tail       = buffer->tail.load( std::memory_order_relaxed );
+      while ( tail < head ) {
+        const size_t offset = tail % buffer->capacity;
+        if ( buffer->capacity - offset < sizeof( RecordHeader ) ) {
+          tail += buffer->capacity - offset;
+          continue;
+        }
+        RecordHeader header;
+        std::memcpy( &header, buffer->data.get() + offset, sizeof( header ) );
+        if ( header.format ) {
+          header.format( buffer->data.get() + offset + sizeof( header ), buffer->text );
+        }
+        tail += header.size;
+      }
+      buffer->tail.store( tail, std::memory_order_release );
+      if ( !buffer->text.empty() ) { iov.push_back( { buffer->text.data(), buffer->text.size() } ); }
+    }
+    writev_all( fd_.load(), iov );
+  }
+
+  static void write_all( int fd, const std::string &text )
+  {
+    std::vector<iovec> iov{ { const_cast<char *>( text.data() ), text.size() } };
+    writev_all( fd, iov );
+  }
+
+  static void writev_all( int fd, std::vector<iovec> &iov )
+  {
+    size_t first = 0;
+    while ( first < iov.size() ) {
+      const int count = static_cast<int>( std::min<size_t>( iov.size() - first, IOV_MAX ) );
+      const ssize_t n = ::writev( fd, iov.data() + first, count );
+      if ( n < 0 ) {
+        if ( errno == EINTR ) { continue; }
+        return;  // 写不出去就丢弃，日志不能让程序失败
+      }
+      // 跳过已经完整写出的段，部分写出的段调整起点
+      auto written = static_cast<size_t>( n );
+      while ( first < iov.size() && written >= iov[ first ].iov_len ) { written -= iov[ first++ ].iov_len; }
+      if ( first < iov.size() ) {
+        iov[ first ].iov_base = static_cast<char *>( iov[ first ].iov_base ) + written;
+        iov[ first ].iov_len -= written;
+      }
+    }
+  }
+
+  static constexpr auto kFlushInterval = std::chrono::milliseconds( 2 );
+
+  std::atomic<int> fd_{ STDOUT_FILENO };
+  std::atomic<uint64_t> stalls_{ 0 };
+  std::mutex buffers_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  std::mutex drain_mutex_;  // 消费缓冲区和写出 fd 的互斥
+  std::atomic<bool> stopped_{ false };  // 后台线程已经退出
+  std::mutex flush_mutex_;
+  std::condition_variable_any wake_;
+  std::condition_variable flushed_;
+  uint64_t flush_requested_ = 0;
+  uint64_t flush_done_      = 0;
+  bool drain_requested_     = false;  // 有生产者因缓冲区写满而等待
+  std::jthread flusher_;
+};
+
+// 常用的写法：log_info( "在位置(", x, ",", y, ")渲染" )，参数依次拼接成一行。
+// 被编译期级别过滤掉的调用连 Logger 都不会创建
+template <LogLevel Level, typename... Args>
+void log( const Args &...args )
+{
+  if constexpr ( Level >= kCompiledLogLevel && Level != LogLevel::Off ) {
+    Logger::get_instance().log<Level>( args... );
+  }
+}
+
+template <typename... Args>
+void log_debug( const Args &...args )
+{
+  log<LogLevel::Debug>( args... );
+}
+
+template <typename... Args>
+void log_info( const Args &...args )
+{
+  log<LogLevel::Info>( args... );
+}
+
+template <typename... Args>
+void log_warn( const Args &...args )
+{
+  log<LogLevel::Warn>( args... );
+}
+
+template <typename... Args>
+void log_error( const Args &...args )
+{
+  log<LogLevel::Error>( args... );
+}
+
+inline void log_flush() { Logger::get_instance().flush(); }
+
+}  // namespace DesignPatterns::Singleton
+
+#endif  // DESIGN_PATTERNS_SINGLETON_LOGGER_H
@@ -0,0 +1,220 @@
+#ifndef DESIGN_PATTERNS_SINGLETON_QUERY_PIPELINE_H
+#define DESIGN_PATTERNS_SINGLETON_QUERY_PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "creational/singleton/connection_pool.h"
+
+namespace DesignPatterns::Singleton
+{
+
+// 规范化查询：合并空白，把数字和单引号字符串字面量换成 '?'，字面量按顺序放入 params。
+// 只有字面量不同的查询得到相同的文本，可以共用一条预备语句
+inline std::string normalize_query( std::string_view sql, std::vector<std::string> &params )
+{
+  auto is_word = []( char c ) { return std::isalnum( static_cast<unsigned char>( c ) ) || c == '_'; };
+  std::string out;
+  out.reserve( sql.size() );
+  for ( size_t i = 0; i < sql.size(); ) {
+    const char c = sql[ i ];
+    if ( std::isspace( static_cast<unsigned char>( c ) ) ) {
+      while ( i < sql.size() && std::isspace( static_cast<unsigned char>( sql[ i ] ) ) ) { ++i; }
+      if ( !out.empty() && i < sql.size() ) { out += ' '; }
+    } else if ( c == '\'' ) {
+      size_t end = i + 1;  // 两个连续的单引号表示转义
+      while ( end < sql.size() && !( sql[ end ] == '\'' && ( end + 1 == sql.size() || sql[ end + 1 ] != '\'' ) ) ) {
+        end += sql[ end ] == '\'' ? 2 : 1;
+      }
+      end = std::min( end + 1, sql.size() );
+      params.emplace_back( sql.substr( i, end - i ) );
+      out += '?';
+      i = end;
+    } else if ( std::isdigit( static_cast<unsigned char>( c ) ) && ( i == 0 || !is_word( sql[ i - 1 ] ) ) ) {
+      size_t end = i;
+      while ( end < sql.size() && ( is_word( sql[ end ] ) || sql[ end ] == '.' ) ) { ++end; }
+      params.emplace_back( sql.substr( i, end - i ) );
+      out += '?';
+      i = end;
+    } else {
+      out += c;
+      ++i;
+    }
+  }
+  return out;
+}
+
+struct PipelineOptions {
+  std::chrono::microseconds batch_window = std::chrono::microseconds( 200 );  // 第一条查询最多等待这么久再发出
+  size_t max_batch                       = 64;   // 一次往返最多携带的查询数
+  size_t dispatchers                     = 4;    // 同时占用的连接数
+  size_t statement_cache                 = 256;  // 每个连接缓存的预备语句数量
+};
+
+struct PipelineStats {
+  uint64_t submitted  = 0;
+  uint64_t batches    = 0;
+  uint64_t prepared   = 0;  // 预备语句缓存未命中，需要在连接上 prepare 的次数
+  uint64_t cache_hits = 0;
+};
+
+// 异步查询管线
+// submit() 把查询规范化后放入队列并立即返回 future。分发线程取出第一条查询后最多再等 batch_window，
+// 把这段时间内到达的查询（不超过 max_batch 条）合成一批，从连接池借一个连接，通过预备语句一次往返执行整批。
+// 预备语句按规范化后的文本缓存在每个连接上（LRU），同一形状的查询只在每个连接上解析一次
+class QueryPipeline
+{
+ public:
+  explicit QueryPipeline( ConnectionPool &pool, PipelineOptions options = {} )
+      : pool_( pool ), options_( options ), caches_( pool.max_size() )
+  {
+    options_.max_batch       = std::max<size_t>( options_.max_batch, 1 );
+    options_.statement_cache = std::max<size_t>( options_.statement_cache, 1 );
+    for ( size_t i = 0; i < std::max<size_t>( options_.dispatchers, 1 ); ++i ) {
+      dispatchers_.emplace_back( [ this ]( std::stop_token token ) { run( token ); } );
+    }
+  }
+
+  QueryPipeline( const QueryPipeline & )            = delete;
+  QueryPipeline &operator=( const QueryPipeline & ) = delete;
+
+  // 队列中剩余的查询执行完后才退出
+  ~QueryPipeline()
+  {
+    for ( auto &d : dispatchers_ ) { d.request_stop(); }
+    ready_.notify_all();
+  }  // jthread 析构时自动 join
+
+  std::future<std::string> submit( std::string query )
+  {
+    Request request;
+    request.text = normalize_query( query, request.params );
+    auto result  = request.promise.get_future();
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      queue_.push_back( std::move( request ) );
+    }
+    submitted_.fetch_add( 1, std::memory_order_relaxed );
+    ready_.notify_one();
+    return result;
+  }
+
+  PipelineStats stats() const
+  {
+    return { submitted_.load(), batches_.load(), prepared_.load(), cache_hits_.load() };
+  }
+
+ private:
+  struct Request {
+    std::string text;
+    std::vector<std::string> params;
+    std::promise<std::string> promise;
+  };
+
+  // 一个连接上的预备语句缓存，只被持有该连接的分发线程访问
+  struct StatementCache {
+    std::list<std::pair<std::string, uint64_t>> entries;  // 最近使用的在前
+    std::unordered_map<std::string_view, std::list<std::pair<std::string, uint64_t>>::iterator> index;
+  };
+
+  void run( std::stop_token token )
+  {
+    std::vector<Request> batch;
+    for ( ;; ) {
+      {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        ready_.wait( lock, token, [ this ]() { return !queue_.empty(); } );
+        if ( queue_.empty() ) { return; }  // 已请求停止且队列为空
+        // 第一条查询到达后再等一个窗口，让后面的查询赶上同一批
+        const auto deadline = std::chrono::steady_clock::now() + options_.batch_window;
+        ready_.wait_until( lock, token, deadline, [ this ]() { return queue_.size() >= options_.max_batch; } );
+        const size_t n = std::min( queue_.size(), options_.max_batch );
+        for ( size_t i = 0; i < n; ++i ) {
+          batch.push_back( std::move( queue_.front() ) );
+          queue_.pop_front();
+        }
+      }
+      if ( batch.empty() ) { continue; }  // 被其他分发线程取走了
+      execute( batch );
+      batch.clear();
+    }
+  }
+
+  void execute( std::vector<Request> &batch )
+  {
+    try {
+      auto connection       = pool_.checkout();
+      StatementCache &cache = caches_[ connection.id() ];
+      std::vector<BoundStatement> statements;
+      statements.reserve( batch.size() );
+      for ( auto &request : batch ) {
+        statements.push_back( { statement( *connection, cache, request.text ), std::move( request.params ) } );
+      }
+      std::vector<std::string> results = connection->execute_batch( statements );
+      if ( results.size() != batch.size() ) {
+        throw std::runtime_error( "QueryPipeline: batch result size mismatch" );
+      }
+      batches_.fetch_add( 1, std::memory_order_relaxed );
+      for ( size_t i = 0; i < batch.size(); ++i ) { batch[ i ].promise.set_value( std::move( results[ i ] ) ); }
+    } catch ( ... ) {
+      for ( auto &request : batch ) {
+        try {
+          request.promise.set_exception( std::current_exception() );
+        } catch ( const std::future_error & ) {  // 出错前已经设置了结果
+        }
+      }
+    }
+  }
+
+  uint64_t statement( Connection &connection, StatementCache &cache, const std::string &text )
+  {
+    if ( auto it = cache.index.find( text ); it != cache.index.end() ) {
+      cache.entries.splice( cache.entries.begin(), cache.entries, it->second );
+      cache_hits_.fetch_add( 1, std::memory_order_relaxed );
+      return it->second->second;
+    }
+    const uint64_t id = connection.prepare( text );
+    prepared_.fetch_add( 1, std::memory_order_relaxed );
+    if ( cache.entries.size() >= options_.statement_cache ) {
+      cache.index.erase( cache.entries.back().first );
+      cache.entries.pop_back();
+    }
+    cache.entries.emplace_front( text, id );
+    cache.index.emplace( cache.entries.front().first, cache.entries.begin() );
+    return id;
+  }
+
+  ConnectionPool &pool_;
+  PipelineOptions options_;
+  std::vector<StatementCache> caches_;  // 按连接在池中的编号
+  std::mutex mutex_;
+  std::condition_variable_any ready_;
+  std::deque<Request> queue_;
+  std::atomic<uint64_t> submitted_{ 0 };
+  std::atomic<uint64_t> batches_{ 0 };
+  std::atomic<uint64_t> prepared_{ 0 };
+  std::atomic<uint64_t> cache_hits_{ 0 };
+  std::vector<std::jthread> dispatchers_;  // 最后声明，最先析构
+};
+
+}  // namespace DesignPatterns::Singleton
+
+#endif  // DESIGN_PATTERNS_SINGLETON_QUERY_PIPELINE_H
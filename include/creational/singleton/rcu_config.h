@@ -0,0 +1,168 @@
+#ifndef DESIGN_PATTERNS_SINGLETON_RCU_CONFIG_H
+#define DESIGN_PATTERNS_SINGLETON_RCU_CONFIG_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace DesignPatterns::Singleton
+{
+
+namespace detail
+{
+
+// 每个线程固定使用的读者槽位，线程按创建顺序轮流分配，槽位数量以内的线程互不共享
+inline size_t reader_slot( size_t slots )
+{
+  static std::atomic<size_t> next{ 0 };
+  thread_local const size_t index = next.fetch_add( 1, std::memory_order_relaxed );
+  return index % slots;
+}
+
+}  // namespace detail
+
+// 读多写少的配置（read-copy-update）
+// 当前版本是一个不可变对象，通过原子指针发布。读者进入时在自己的槽位上登记当前纪元（epoch）的奇偶，
+// 然后直接读指针，不加锁也不分配内存；写者复制出新版本、原子地替换指针，再把纪元加一，
+// 等待所有登记在旧纪元上的读者离开（宽限期）后回收旧版本。写者之间用互斥锁串行
+template <typename T>
+class RcuConfig
+{
+  struct Version {
+    T value;
+    uint64_t number;
+  };
+
+  struct alignas( 64 ) ReaderSlot {
+    std::atomic<uint32_t> active[ 2 ] = { 0, 0 };  // 按纪元奇偶计数的读者
+  };
+
+  static constexpr size_t kSlots = 64;
+
+ public:
+  using Callback = std::function<void( const T &, uint64_t version )>;
+
+  // 读取期间有效的快照，析构时离开读侧临界区；不要在持有快照时发布新版本，否则会等待自己
+  class Snapshot
+  {
+   public:
+    Snapshot( Snapshot &&other ) noexcept
+        : slot_( std::exchange( other.slot_, nullptr ) ), parity_( other.parity_ ), version_( other.version_ )
+    {
+    }
+    Snapshot( const Snapshot & )            = delete;
+    Snapshot &operator=( const Snapshot & ) = delete;
+    Snapshot &operator=( Snapshot && )      = delete;
+
+    ~Snapshot()
+    {
+      if ( slot_ ) { slot_->active[ parity_ ].fetch_sub( 1, std::memory_order_release ); }
+    }
+
+    const T &operator*() const { return version_->value; }
+    const T *operator->() const { return &version_->value; }
+    uint64_t version() const { return version_->number; }
+
+   private:
+    friend class RcuConfig;
+
+    Snapshot( ReaderSlot *slot, unsigned parity, const Version *version )
+        : slot_( slot ), parity_( parity ), version_( version )
+    {
+    }
+
+    ReaderSlot *slot_;
+    unsigned parity_;
+    const Version *version_;
+  };
+
+  explicit RcuConfig( T initial = T{} ) : current_( new Version{ std::move( initial ), 1 } ) {}
+
+  RcuConfig( const RcuConfig & )            = delete;
+  RcuConfig &operator=( const RcuConfig & ) = delete;
+
+  ~RcuConfig() { delete current_.load(); }
+
+  Snapshot read() const
+  {
+    ReaderSlot &slot = slots_[ detail::reader_slot( kSlots ) ];
+    for ( ;; ) {
+      const uint64_t epoch  = epoch_.load();
+      const unsigned parity = static_cast<unsigned>( epoch & 1 );
+      slot.active[ parity ].fetch_add( 1 );
+      // 登记之后纪元没有变，写者要么能看到这次登记，要么还没开始翻转纪元
+      if ( epoch_.load() == epoch ) { return Snapshot( &slot, parity, current_.load() ); }
+      slot.active[ parity ].fetch_sub( 1 );
+    }
+  }
+
+  uint64_t version() const { return read().version(); }
+
+  // 发布一个全新的版本，返回它的版本号
+  uint64_t publish( T value )
+  {
+    return update( [ &value ]( T &next ) { next = std::move( value ); } );
+  }
+
+  // 复制当前版本，交给 fn 修改后发布
+  template <typename Fn>
+  uint64_t update( Fn &&fn )
+  {
+    std::lock_guard<std::mutex> lock( writer_mutex_ );
+    const Version *old = current_.load();
+    auto *next         = new Version{ old->value, old->number + 1 };
+    try {
+      fn( next->value );
+    } catch ( ... ) {
+      delete next;
+      throw;
+    }
+    current_.store( next );
+    synchronize();
+    delete old;
+    for ( const auto &[ id, callback ] : subscribers_ ) { callback( next->value, next->number ); }
+    return next->number;
+  }
+
+  // 订阅版本变化，回调在写者线程上、新版本发布之后调用；回调里不能再发布新版本
+  size_t subscribe( Callback callback )
+  {
+    std::lock_guard<std::mutex> lock( writer_mutex_ );
+    subscribers_.emplace_back( ++last_subscriber_, std::move( callback ) );
+    return last_subscriber_;
+  }
+
+  void unsubscribe( size_t id )
+  {
+    std::lock_guard<std::mutex> lock( writer_mutex_ );
+    std::erase_if( subscribers_, [ id ]( const auto &entry ) { return entry.first == id; } );
+  }
+
+ private:
+  // 翻转纪元并等待旧纪元上的读者全部离开；新来的读者只会看到新纪元和新版本
+  void synchronize()
+  {
+    const uint64_t epoch  = epoch_.fetch_add( 1 );
+    const unsigned parity = static_cast<unsigned>( epoch & 1 );
+    for ( auto &slot : slots_ ) {
+      while ( slot.active[ parity ].load() != 0 ) { std::this_thread::yield(); }
+    }
+  }
+
+  std::atomic<const Version *> current_;
+  std::atomic<uint64_t> epoch_{ 0 };
+  mutable std::array<ReaderSlot, kSlots> slots_;
+  std::mutex writer_mutex_;
+  std::vector<std::pair<size_t, Callback>> subscribers_;
+  size_t last_subscriber_ = 0;
+};
+
+}  // namespace DesignPatterns::Singleton
+
+#endif  // DESIGN_PATTERNS_SINGLETON_RCU_CONFIG_H
@@ -0,0 +1,311 @@
+#ifndef DESIGN_PATTERNS_SINGLETON_SERVICE_REGISTRY_H
+#define DESIGN_PATTERNS_SINGLETON_SERVICE_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DesignPatterns::Singleton
+{
+
+class ServiceNotFound : public std::runtime_error
+{
+ public:
+  explicit ServiceNotFound( std::string_view name )
+      : std::runtime_error( "ServiceRegistry: no service registered as '" + std::string( name ) + "'" )
+  {
+  }
+};
+
+namespace detail
+{
+
+// 每个类型一个唯一的地址，用作类型键，不依赖 RTTI
+template <typename T>
+inline const void *type_key()
+{
+  static constexpr char key = 0;
+  return &key;
+}
+
+}  // namespace detail
+
+// 服务注册表：按（类型，名字）保存多个进程级的服务，第一次 get 时才构造
+// 键按哈希分到若干分片，每个分片的索引是一张只读的开放寻址表，通过原子指针发布：
+// 查找只读指针和探测，不加锁；注册在分片的互斥锁下复制出新表再替换，旧表保留到注册表析构（注册很少发生）。
+// shutdown() 按构造完成的逆序销毁服务：工厂里 get 到的依赖一定先构造完成，因此后销毁。
+// 构造时维护一张等待图（哪个线程在构造哪个服务、哪个线程在等哪个服务），跨线程的循环依赖也能发现而不会死锁
+class ServiceRegistry
+{
+ public:
+  template <typename T>
+  using Factory = std::function<std::unique_ptr<T>( ServiceRegistry & )>;
+
+  ServiceRegistry() = default;
+
+  ServiceRegistry( const ServiceRegistry & )            = delete;
+  ServiceRegistry &operator=( const ServiceRegistry & ) = delete;
+
+  ~ServiceRegistry() { shutdown(); }
+
+  // 进程级的注册表，Singleton<T> 使用它
+  static ServiceRegistry &global()
+  {
+    static ServiceRegistry instance;
+    return instance;
+  }
+
+  // 注册工厂，同一类型和名字已经注册过时返回 false
+  template <typename T>
+  bool add( std::string name, Factory<T> factory )
+  {
+    auto entry    = std::make_unique<Entry>();
+    entry->type   = detail::type_key<T>();
+    entry->name   = std::move( name );
+    entry->hash   = hash( entry->type, entry->name );
+    entry->create = [ factory = std::move( factory ), name = entry->name ]( ServiceRegistry &registry ) -> void * {
+      std::unique_ptr<T> service = factory( registry );
+      if ( !service ) { throw std::runtime_error( "ServiceRegistry: factory for '" + name + "' returned null" ); }
+      return service.release();
+    };
+    entry->destroy = []( void *p ) { delete static_cast<T *>( p ); };
+    return insert( std::move( entry ) ) != nullptr;
+  }
+
+  template <typename T>
+  bool add( Factory<T> factory )
+  {
+    return add<T>( std::string(), std::move( factory ) );
+  }
+
+  // 取得服务，必要时构造。未注册的无名服务若可默认构造，则自动注册；否则抛出 ServiceNotFound。
+  // 工厂里可以 get 其他服务，循环依赖（包括多个线程从不同端进入同一个环）抛出 std::logic_error，
+  // 工厂返回空指针抛出 std::runtime_error，两种情况下服务都不会被记为已构造，之后可以再次尝试
+  template <typename T>
+  T &get( std::string_view name = {} )
+  {
+    const void *type  = detail::type_key<T>();
+    const size_t code = hash( type, name );
+    Entry *entry      = find( type, name, code );
+    if ( !entry ) {
+      if constexpr ( std::is_default_constructible_v<T> ) {
+        if ( name.empty() ) {
+          add<T>( []( ServiceRegistry & ) { return std::make_unique<T>(); } );
+          entry = find( type, name, code );
+        }
+      }
+      if ( !entry ) { throw ServiceNotFound( name ); }
+    }
+    return *static_cast<T *>( instance( *entry ) );
+  }
+
+  template <typename T>
+  bool contains( std::string_view name = {} ) const
+  {
+    const void *type = detail::type_key<T>();
+    return find( type, name, hash( type, name ) ) != nullptr;
+  }
+
+  // 按构造完成的逆序销毁所有已构造的服务，注册信息保留，之后再 get 会重新构造
+  void shutdown()
+  {
+    std::lock_guard<std::mutex> lock( order_mutex_ );
+    generation_.fetch_add( 1, std::memory_order_release );
+    while ( !constructed_.empty() ) {
+      Entry *entry = constructed_.back();
+      constructed_.pop_back();
+      entry->destroy( entry->instance.exchange( nullptr, std::memory_order_acq_rel ) );
+    }
+  }
+
+  // 每次 shutdown() 加一；缓存了服务指针的调用方（如 Singleton<T>）据此判断指针是否还有效
+  uint64_t generation() const { return generation_.load( std::memory_order_acquire ); }
+
+  size_t size() const
+  {
+    size_t count = 0;
+    for ( const auto &shard : shards_ ) {
+      if ( const Table *table = shard.table.load( std::memory_order_acquire ) ) { count += table->count; }
+    }
+    return count;
+  }
+
+  size_t constructed() const
+  {
+    std::lock_guard<std::mutex> lock( order_mutex_ );
+    return constructed_.size();
+  }
+
+ private:
+  struct Entry {
+    const void *type = nullptr;
+    std::string name;
+    size_t hash = 0;
+    std::function<void *( ServiceRegistry & )> create;
+    void ( *destroy )( void * ) = nullptr;
+    std::atomic<void *> instance{ nullptr };
+    std::thread::id builder;  // 正在构造该服务的线程，由 graph_mutex_ 保护
+    std::mutex mutex;
+  };
+
+  // 只读的开放寻址表，容量为 2 的幂，装载率不超过一半
+  struct Table {
+    explicit Table( size_t capacity ) : mask( capacity - 1 ), slots( capacity, nullptr ) {}
+    size_t mask;
+    size_t count = 0;
+    std::vector<Entry *> slots;
+  };
+
+  struct alignas( 64 ) Shard {
+    std::atomic<const Table *> table{ nullptr };
+    std::mutex mutex;  // 只有注册者使用
+    std::vector<std::unique_ptr<Table>> tables;  // 发布过的所有表，最后一张是当前表
+    std::vector<std::unique_ptr<Entry>> entries;
+  };
+
+  static constexpr size_t kShards = 16;
+
+  static size_t hash( const void *type, std::string_view name )
+  {
+    const size_t h = std::hash<std::string_view>{}( name ) ^
+                     static_cast<size_t>( reinterpret_cast<uintptr_t>( type ) * 0x9e3779b97f4a7c15ull );
+    return h ^ ( h >> 29 );
+  }
+
+  // 低位选分片，高位在分片内探测
+  static Entry *probe( const Table &table, const void *type, std::string_view name, size_t code )
+  {
+    for ( size_t i = code / kShards;; ++i ) {
+      Entry *entry = table.slots[ i & table.mask ];
+      if ( !entry ) { return nullptr; }
+      if ( entry->hash == code && entry->type == type && entry->name == name ) { return entry; }
+    }
+  }
+
+  Entry *find( const void *type, std::string_view name, size_t code ) const
+  {
+    const Table *table = shards_[ code % kShards ].table.load( std::memory_order_acquire );
+    return table ? probe( *table, type, name, code ) : nullptr;
+  }
+
+  // 插入新条目，已存在时返回 nullptr
+  Entry *insert( std::unique_ptr<Entry> entry )
+  {
+    Shard &shard = shards_[ entry->hash % kShards ];
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    const Table *current = shard.table.load( std::memory_order_relaxed );
+    if ( current && probe( *current, entry->type, entry->name, entry->hash ) ) { return nullptr; }
+    const size_t count = current ? current->count + 1 : 1;
+    size_t capacity    = current ? current->mask + 1 : 8;
+    while ( count * 2 > capacity ) { capacity *= 2; }
+    auto next   = std::make_unique<Table>( capacity );
+    next->count = count;
+    auto place  = [ &next ]( Entry *e ) {
+      size_t i = e->hash / kShards;
+      while ( next->slots[ i & next->mask ] ) { ++i; }
+      next->slots[ i & next->mask ] = e;
+    };
+    if ( current ) {
+      for ( Entry *e : current->slots ) {
+        if ( e ) { place( e ); }
+      }
+    }
+    Entry *added = entry.get();
+    place( added );
+    shard.entries.push_back( std::move( entry ) );
+    shard.table.store( next.get(), std::memory_order_release );
+    shard.tables.push_back( std::move( next ) );  // 旧表可能仍有读者，不释放
+    return added;
+  }
+
+  // 准备等待 entry 之前沿等待图走一遍：entry 的构造者在等谁、那个服务的构造者又在等谁……
+  // 走回到当前线程说明等下去会形成环。检查和登记在同一把锁下完成，环上最后一个加入的线程一定能发现
+  void waitFor( Entry &entry, std::thread::id self )
+  {
+    std::lock_guard<std::mutex> lock( graph_mutex_ );
+    for ( const Entry *e = &entry; e->builder != std::thread::id(); ) {
+      if ( e->builder == self ) {
+        throw std::logic_error( "ServiceRegistry: circular dependency on '" + entry.name + "'" );
+      }
+      auto it = waiting_.find( e->builder );
+      if ( it == waiting_.end() ) { break; }
+      e = it->second;
+    }
+    waiting_[ self ] = &entry;
+  }
+
+  void *instance( Entry &entry )
+  {
+    if ( void *p = entry.instance.load( std::memory_order_acquire ) ) { return p; }
+    const std::thread::id self = std::this_thread::get_id();
+    waitFor( entry, self );
+    std::lock_guard<std::mutex> lock( entry.mutex );
+    {
+      std::lock_guard<std::mutex> graph( graph_mutex_ );
+      waiting_.erase( self );
+      if ( void *p = entry.instance.load( std::memory_order_acquire ) ) { return p; }
+      entry.builder = self;
+    }
+    auto clear_builder = [ this, &entry ]() {
+      std::lock_guard<std::mutex> graph( graph_mutex_ );
+      entry.builder = std::thread::id();
+    };
+    void *p = nullptr;
+    try {
+      p = entry.create( *this );
+    } catch ( ... ) {
+      clear_builder();
+      throw;
+    }
+    clear_builder();
+    {
+      std::lock_guard<std::mutex> order( order_mutex_ );
+      constructed_.push_back( &entry );
+      entry.instance.store( p, std::memory_order_release );
+    }
+    return p;
+  }
+
+  std::array<Shard, kShards> shards_;
+  std::atomic<uint64_t> generation_{ 0 };
+  mutable std::mutex order_mutex_;
+  std::vector<Entry *> constructed_;  // 构造完成的顺序
+  std::mutex graph_mutex_;            // 只在构造服务时使用，已构造服务的 get 不经过它
+  std::unordered_map<std::thread::id, Entry *> waiting_;  // 线程 -> 它正在等待构造完成的服务
+};
+
+// 通用单例：Singleton<T>::get() 取全局注册表中的 T，第一次访问后把指针连同注册表的代数缓存在线程局部变量里，
+// 之后的访问只比较一次代数。全局注册表 shutdown() 之后代数变化，下次访问重新取得（必要时重新构造）服务；
+// shutdown() 仍然不能与正在使用服务的线程并发
+template <typename T>
+class Singleton
+{
+ public:
+  static T &get()
+  {
+    thread_local T *cached                  = nullptr;
+    thread_local uint64_t cached_generation = 0;
+    ServiceRegistry &registry               = ServiceRegistry::global();
+    const uint64_t generation               = registry.generation();
+    if ( cached && cached_generation == generation ) [[likely]] { return *cached; }
+    cached            = &registry.get<T>();
+    cached_generation = generation;
+    return *cached;
+  }
+};
+
+}  // namespace DesignPatterns::Singleton
+
+#endif  // DESIGN_PATTERNS_SINGLETON_SERVICE_REGISTRY_H
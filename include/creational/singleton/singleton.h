@@ -1,13 +1,49 @@
 #ifndef DESIGN_PATTERNS_SINGLETON_H
 #define DESIGN_PATTERNS_SINGLETON_H
 
+#include <cstddef>
+#include <cstdint>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
+
+#include "creational/singleton/connection_pool.h"
+#include "creational/singleton/logger.h"
+#include "creational/singleton/query_pipeline.h"
+#include "creational/singleton/rcu_config.h"
+#include "creational/singleton/service_registry.h"
 
 namespace DesignPatterns::Singleton
 {
 
+struct DatabaseConfig {
+  std::string connection_string;
+};
+
+// get_connection_string() 的返回值：持有配置快照，按 std::string_view 读取，不加锁也不复制字符串。
+// 需要 std::string 时才会复制。它和快照一样，不要长期持有，也不要在持有时发布新的配置
+class ConnectionString
+{
+ public:
+  explicit ConnectionString( RcuConfig<DatabaseConfig>::Snapshot snapshot ) : snapshot_( std::move( snapshot ) ) {}
+
+  std::string_view view() const { return snapshot_->connection_string; }
+  size_t size() const { return view().size(); }
+
+  operator std::string_view() const { return view(); }
+  operator std::string() const { return std::string( view() ); }
+
+  friend bool operator==( const ConnectionString &lhs, std::string_view rhs ) { return lhs.view() == rhs; }
+  friend std::ostream &operator<<( std::ostream &os, const ConnectionString &s ) { return os << s.view(); }
+
+ private:
+  RcuConfig<DatabaseConfig>::Snapshot snapshot_;
+};
+
 class Database
 {
  public:
@@ -17,23 +53,43 @@ class Database
     return instance;
   }
 
+  // 查询从连接池借一个连接执行，多个线程可以同时查询
   void execute_query( const std::string &query )
   {
-    std::cout << "Executing query: " << query << " on Database instance @" << this << std::endl;
+    auto connection = pool_.checkout();
+    connection->execute( query );
+    log_info( "Executing query: ", query, " on Database instance @", this, " (conn#", connection.id(), ")" );
   }
 
-  // 使用锁保证线程安全
+  std::string query( const std::string &sql ) { return pool_.checkout()->execute( sql ); }
+
+  // 异步查询：与其他查询合批，通过预备语句执行；管线在第一次调用时创建
+  std::future<std::string> submit( std::string query )
+  {
+    std::call_once( pipeline_once_, [ this ]() { pipeline_ = std::make_unique<QueryPipeline>( pool_ ); } );
+    return pipeline_->submit( std::move( query ) );
+  }
+
+  ConnectionPool &pool() { return pool_; }
+
+  // 配置以 RCU 方式发布：写者复制出新版本后原子替换，读者不加锁
   void set_connection_string( const std::string &conn_str )
   {
-    std::lock_guard<std::mutex> lock( mutex_ );
-    connection_string_ = conn_str;
+    config_.update( [ &conn_str ]( DatabaseConfig &config ) { config.connection_string = conn_str; } );
   }
 
-  std::string get_connection_string() const
+  // 读取不加锁也不分配内存；保存成 std::string 时才复制
+  ConnectionString get_connection_string() const { return ConnectionString( config_.read() ); }
+
+  // 需要同时读取多个字段时直接持有快照
+  RcuConfig<DatabaseConfig>::Snapshot config() const { return config_.read(); }
+  uint64_t config_version() const { return config_.version(); }
+
+  size_t subscribe_config( RcuConfig<DatabaseConfig>::Callback callback )
   {
-    std::lock_guard<std::mutex> lock( mutex_ );
-    return connection_string_;
+    return config_.subscribe( std::move( callback ) );
   }
+  void unsubscribe_config( size_t id ) { config_.unsubscribe( id ); }
 
  private:
   // 私有构造函数，防止外部直接实例化
@@ -45,8 +101,13 @@ class Database
   Database( const Database & )            = delete;
   Database &operator=( const Database & ) = delete;
 
-  std::string connection_string_;
-  mutable std::mutex mutex_;  // Added mutable mutex for thread safety in const methods
+  RcuConfig<DatabaseConfig> config_;
+  // 默认连接到进程内的假后端，新连接使用建立时的连接字符串
+  ConnectionPool pool_{ [ this ]( size_t id ) {
+    return std::make_unique<FakeConnection>( id, get_connection_string() );
+  } };
+  std::once_flag pipeline_once_;
+  std::unique_ptr<QueryPipeline> pipeline_;  // 在连接池之前析构
 };
 
 }  // namespace DesignPatterns::Singleton
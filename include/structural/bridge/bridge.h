@@ -1,10 +1,11 @@
 #ifndef DESIGN_PATTERNS_STRUCTURAL_BRIDGE_H
 #define DESIGN_PATTERNS_STRUCTURAL_BRIDGE_H
 
-#include <iostream>
 #include <memory>
 #include <string>
 
+#include "creational/singleton/logger.h"
+
 namespace DesignPatterns::Bridge
 {
 
@@ -23,7 +24,7 @@ class VectorRenderer : public Renderer
  public:
   void render_circle( float radius ) override
   {
-    std::cout << "[Vector] Drawing a circle using mathematical curves, radius=" << radius << std::endl;
+    Singleton::log_info( "[Vector] Drawing a circle using mathematical curves, radius=", radius );
   }
 
   std::string get_renderer_name() const override { return "VectorRenderer"; }
@@ -35,7 +36,7 @@ class RasterRenderer : public Renderer
  public:
   void render_circle( float radius ) override
   {
-    std::cout << "[Raster] Drawing circle pixels, radius=" << radius << std::endl;
+    Singleton::log_info( "[Raster] Drawing circle pixels, radius=", radius );
   }
 
   std::string get_renderer_name() const override { return "RasterRenderer"; }
@@ -66,7 +67,7 @@ class Circle : public Shape
 
   void draw() override
   {
-    std::cout << "Circle (Abstraction) is asking renderer to draw:" << std::endl;
+    Singleton::log_info( "Circle (Abstraction) is asking renderer to draw:" );
     renderer_->render_circle( radius_ );
   }
 
@@ -2,14 +2,50 @@
 #define DESIGN_PATTERNS_STRUCTURAL_COMPOSITE_H
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace DesignPatterns::Composite
 {
 
+namespace detail
+{
+
+inline uint64_t mix_hash( uint64_t x )
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  return x ^ ( x >> 31 );
+}
+
+inline uint64_t hash_name( std::string_view name )
+{
+  uint64_t h = 14695981039346656037ull;
+  for ( unsigned char c : name ) { h = ( h ^ c ) * 1099511628211ull; }
+  return h;
+}
+
+// 叶子节点的哈希只取决于名字和大小
+inline uint64_t leaf_hash( std::string_view name, int64_t size )
+{
+  return mix_hash( hash_name( name ) ^ ( static_cast<uint64_t>( size ) * 0x9e3779b97f4a7c15ull ) );
+}
+
+// 目录的哈希：从 directory_hash_seed 开始，对每个子节点累加 directory_hash_step，最后再混合一次
+inline uint64_t directory_hash_seed( std::string_view name ) { return hash_name( name ) * 0xff51afd7ed558ccdull + 1; }
+inline uint64_t directory_hash_step( uint64_t child_hash ) { return mix_hash( child_hash ); }
+
+}  // namespace detail
+
+class Directory;
+
 // 1. Component (抽象组件)
 class FileSystemNode
 {
@@ -22,10 +58,50 @@ class FileSystemNode
   virtual int get_size() const               = 0;
   virtual void add( std::shared_ptr<FileSystemNode> node ) { throw std::runtime_error( "Cannot add to a leaf node" ); }
 
-  std::string get_name() const { return name_; }
+  virtual bool is_directory() const { return false; }
+
+  // 叶子节点没有子节点
+  virtual const std::vector<std::shared_ptr<FileSystemNode>> &children() const
+  {
+    static const std::vector<std::shared_ptr<FileSystemNode>> none;
+    return none;
+  }
+
+  const std::string &get_name() const { return name_; }
+
+  // Merkle 风格的内容哈希：由名字、大小和子树的哈希得到，内容相同的子树哈希相同。
+  // 结果被缓存，节点变化时把自己和所有祖先标记为脏，下次调用时只重算脏的部分；缓存不是线程安全的。
+  // 自己维护缓存的节点（如 arena 视图）可以整体覆盖
+  virtual uint64_t content_hash() const
+  {
+    if ( dirty_ ) {
+      hash_  = compute_hash();
+      dirty_ = false;
+    }
+    return hash_;
+  }
+
+  FileSystemNode *get_parent() const { return parent_; }
 
  protected:
+  friend class Directory;
+
+  // 能否挂到 Directory 下：挂上之后节点的变化要能通过 mark_dirty 通知父目录。
+  // 状态保存在别处、变化时不会通知父目录的节点（如 arena 视图）返回 false
+  virtual bool attachable() const { return true; }
+
+  virtual uint64_t compute_hash() const { return detail::leaf_hash( name_, get_size() ); }
+
+  // 祖先已经是脏的就不必再往上走：脏节点的祖先一定也是脏的
+  void mark_dirty()
+  {
+    for ( FileSystemNode *n = this; n && !n->dirty_; n = n->parent_ ) { n->dirty_ = true; }
+  }
+
   std::string name_;
+  FileSystemNode *parent_ = nullptr;  // 所在目录，一个节点只能属于一个目录
+  mutable uint64_t hash_  = 0;
+  mutable bool dirty_     = true;
 
   // 辅助函数：打印缩进
   void print_indent( int indent ) const
@@ -47,6 +123,12 @@ class File : public FileSystemNode
 
   int get_size() const override { return size_; }
 
+  void set_size( int size )
+  {
+    size_ = size;
+    mark_dirty();
+  }
+
  private:
   int size_;
 };
@@ -57,7 +139,46 @@ class Directory : public FileSystemNode
  public:
   explicit Directory( const std::string &name ) : FileSystemNode( name ) {}
 
-  void add( std::shared_ptr<FileSystemNode> node ) override { children_.push_back( node ); }
+  Directory( const Directory & )            = delete;
+  Directory &operator=( const Directory & ) = delete;
+
+  // 子节点是 shared_ptr，可能比目录活得久，不能留下指向已销毁目录的 parent_
+  ~Directory() override
+  {
+    for ( const auto &child : children_ ) {
+      if ( child->parent_ == this ) { child->parent_ = nullptr; }
+    }
+  }
+
+  // 已经属于某个目录的节点先从原目录中移出，原目录的哈希随之失效；不能把目录加到它自己的子树里。
+  // arena 视图不能直接挂进来（arena 变化时不会让这个目录的哈希失效），需要时用 FlatFileSystem::add 复制
+  void add( std::shared_ptr<FileSystemNode> node ) override
+  {
+    if ( !node->attachable() ) {
+      throw std::runtime_error( "Cannot add an arena view to a Directory; copy it into an arena instead" );
+    }
+    for ( const FileSystemNode *n = this; n; n = n->parent_ ) {
+      if ( n == node.get() ) { throw std::runtime_error( "Cannot add a directory to its own subtree" ); }
+    }
+    if ( auto *old_parent = dynamic_cast<Directory *>( node->parent_ ) ) { old_parent->detach( node.get() ); }
+    node->parent_ = this;
+    children_.push_back( std::move( node ) );
+    mark_dirty();
+  }
+
+  // 删除名为 name 的子节点，不存在时返回 false
+  bool remove( const std::string &name )
+  {
+    auto it = std::find_if( children_.begin(), children_.end(),
+                            [ &name ]( const auto &child ) { return child->get_name() == name; } );
+    if ( it == children_.end() ) { return false; }
+    ( *it )->parent_ = nullptr;
+    children_.erase( it );
+    mark_dirty();
+    return true;
+  }
+
+  bool is_directory() const override { return true; }
 
   void print( int indent = 0 ) const override
   {
@@ -73,7 +194,24 @@ class Directory : public FileSystemNode
     return total_size;
   }
 
+  const std::vector<std::shared_ptr<FileSystemNode>> &children() const override { return children_; }
+
+ protected:
+  // 子节点哈希求和后再混合，与子节点的顺序无关，按不同顺序读出的同一个目录哈希相同
+  uint64_t compute_hash() const override
+  {
+    uint64_t acc = detail::directory_hash_seed( name_ );
+    for ( const auto &child : children_ ) { acc += detail::directory_hash_step( child->content_hash() ); }
+    return detail::mix_hash( acc );
+  }
+
  private:
+  void detach( const FileSystemNode *node )
+  {
+    std::erase_if( children_, [ node ]( const auto &child ) { return child.get() == node; } );
+    mark_dirty();
+  }
+
   std::vector<std::shared_ptr<FileSystemNode>> children_;
 };
 
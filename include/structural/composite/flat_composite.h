@@ -0,0 +1,287 @@
+#ifndef DESIGN_PATTERNS_STRUCTURAL_FLAT_COMPOSITE_H
+#define DESIGN_PATTERNS_STRUCTURAL_FLAT_COMPOSITE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "structural/composite/composite.h"
+
+namespace DesignPatterns::Composite
+{
+
+using NodeId                  = uint32_t;
+constexpr NodeId kInvalidNode = std::numeric_limits<NodeId>::max();
+
+// 扁平的组合树：所有节点存放在一个数组（arena）中，用 parent / first_child / next_sibling 下标相连，
+// 名字统一存放在一块字符缓冲区里。每个目录缓存自己子树的总大小，添加文件时沿祖先链更新，get_size() 为 O(1)
+class FlatFileSystem
+{
+ public:
+  explicit FlatFileSystem( std::string_view root_name = "/" ) { push_node( kInvalidNode, root_name, 0, true ); }
+
+  static constexpr NodeId root() { return 0; }
+
+  void reserve( size_t nodes, size_t name_bytes = 0 )
+  {
+    nodes_.reserve( nodes );
+    names_.reserve( name_bytes );
+    hashes_.reserve( nodes );
+    hash_dirty_.reserve( nodes );
+  }
+
+  NodeId add_directory( NodeId parent, std::string_view name ) { return add_child( parent, name, 0, true ); }
+
+  // 新文件的大小累加到所有祖先目录上，开销与深度成正比
+  NodeId add_file( NodeId parent, std::string_view name, int64_t size )
+  {
+    NodeId id = add_child( parent, name, size, false );
+    for ( NodeId p = parent; p != kInvalidNode; p = nodes_[ p ].parent ) { nodes_[ p ].size += size; }
+    return id;
+  }
+
+  // 修改文件大小，差值同样沿祖先链传播
+  void set_file_size( NodeId file, int64_t size )
+  {
+    if ( nodes_[ file ].directory ) { throw std::runtime_error( "Cannot set the size of a directory" ); }
+    const int64_t delta = size - nodes_[ file ].size;
+    for ( NodeId p = file; p != kInvalidNode; p = nodes_[ p ].parent ) { nodes_[ p ].size += delta; }
+    mark_dirty( file );
+  }
+
+  int64_t get_size( NodeId id ) const { return nodes_[ id ].size; }
+  std::string_view get_name( NodeId id ) const
+  {
+    return std::string_view( names_ ).substr( nodes_[ id ].name_offset, nodes_[ id ].name_length );
+  }
+  bool is_directory( NodeId id ) const { return nodes_[ id ].directory; }
+  NodeId parent( NodeId id ) const { return nodes_[ id ].parent; }
+  NodeId first_child( NodeId id ) const { return nodes_[ id ].first_child; }
+  NodeId next_sibling( NodeId id ) const { return nodes_[ id ].next_sibling; }
+
+  size_t node_count() const { return nodes_.size(); }
+  // 每次添加节点加一，视图据此判断缓存的子节点列表是否过期
+  uint64_t generation() const { return generation_; }
+  size_t memory_bytes() const
+  {
+    return nodes_.capacity() * sizeof( Node ) + names_.capacity() + hashes_.capacity() * sizeof( uint64_t ) +
+           hash_dirty_.capacity();
+  }
+
+  // 按添加顺序访问直接子节点，fn( NodeId )
+  template <typename Fn>
+  void for_each_child( NodeId id, Fn &&fn ) const
+  {
+    for ( NodeId c = nodes_[ id ].first_child; c != kInvalidNode; c = nodes_[ c ].next_sibling ) { fn( c ); }
+  }
+
+  // 先序遍历子树，fn( NodeId, int depth )；沿 first_child / next_sibling / parent 移动，不需要栈
+  template <typename Fn>
+  void walk( NodeId id, Fn &&fn ) const
+  {
+    NodeId node = id;
+    int depth   = 0;
+    fn( node, depth );
+    for ( ;; ) {
+      if ( nodes_[ node ].first_child != kInvalidNode ) {
+        node = nodes_[ node ].first_child;
+        ++depth;
+      } else {
+        while ( node != id && nodes_[ node ].next_sibling == kInvalidNode ) {
+          node = nodes_[ node ].parent;
+          --depth;
+        }
+        if ( node == id ) { return; }
+        node = nodes_[ node ].next_sibling;
+      }
+      fn( node, depth );
+    }
+  }
+
+  // 与 File / Directory::print 输出相同
+  void print( NodeId id, int indent = 0 ) const
+  {
+    walk( id, [ this, indent ]( NodeId node, int depth ) {
+      for ( int i = 0; i < indent + depth; ++i ) { std::cout << "  "; }
+      if ( nodes_[ node ].directory ) {
+        std::cout << "+ Directory: " << get_name( node ) << std::endl;
+      } else {
+        std::cout << "- File: " << get_name( node ) << " (" << nodes_[ node ].size << " KB)" << std::endl;
+      }
+    } );
+  }
+
+  // 与 File / Directory::content_hash 相同的 Merkle 哈希，内容相同的 arena 子树和指针树哈希相同。
+  // 每个节点的哈希缓存在 arena 中，修改时把节点和祖先标记为脏；缓存不是线程安全的
+  uint64_t content_hash( NodeId id ) const
+  {
+    if ( hash_dirty_[ id ] ) {
+      const Node &node = nodes_[ id ];
+      if ( node.directory ) {
+        uint64_t acc = detail::directory_hash_seed( get_name( id ) );
+        for_each_child( id, [ this, &acc ]( NodeId c ) { acc += detail::directory_hash_step( content_hash( c ) ); } );
+        hashes_[ id ] = detail::mix_hash( acc );
+      } else {
+        hashes_[ id ] = detail::leaf_hash( get_name( id ), node.size );
+      }
+      hash_dirty_[ id ] = 0;
+    }
+    return hashes_[ id ];
+  }
+
+  // 以 FileSystemNode 接口访问 arena 中的节点，视图只引用 arena，arena 必须比视图活得久
+  std::shared_ptr<FileSystemNode> view( NodeId id );
+
+ private:
+  struct Node {
+    int64_t size;  // 文件为自身大小，目录为子树总大小
+    NodeId parent;
+    NodeId first_child;
+    NodeId last_child;  // 追加子节点为 O(1)
+    NodeId next_sibling;
+    uint32_t name_offset;
+    uint32_t name_length : 31;
+    uint32_t directory : 1;  // 与名字长度共用一个字，节点正好 32 字节
+  };
+  static_assert( sizeof( Node ) == 32 );
+
+  NodeId push_node( NodeId parent, std::string_view name, int64_t size, bool directory )
+  {
+    if ( nodes_.size() >= kInvalidNode ) { throw std::length_error( "FlatFileSystem: too many nodes" ); }
+    if ( names_.size() + name.size() > std::numeric_limits<uint32_t>::max() || name.size() >= ( 1u << 31 ) ) {
+      throw std::length_error( "FlatFileSystem: name buffer exhausted" );
+    }
+    const auto id = static_cast<NodeId>( nodes_.size() );
+    nodes_.push_back( Node{ size, parent, kInvalidNode, kInvalidNode, kInvalidNode,
+                            static_cast<uint32_t>( names_.size() ), static_cast<uint32_t>( name.size() ),
+                            directory ? 1u : 0u } );
+    names_.append( name );
+    hashes_.push_back( 0 );
+    hash_dirty_.push_back( 1 );
+    ++generation_;
+    return id;
+  }
+
+  NodeId add_child( NodeId parent, std::string_view name, int64_t size, bool directory )
+  {
+    if ( !nodes_[ parent ].directory ) { throw std::runtime_error( "Cannot add to a leaf node" ); }
+    const NodeId id = push_node( parent, name, size, directory );
+    Node &p         = nodes_[ parent ];
+    if ( p.last_child == kInvalidNode ) {
+      p.first_child = id;
+    } else {
+      nodes_[ p.last_child ].next_sibling = id;
+    }
+    p.last_child = id;
+    mark_dirty( parent );
+    return id;
+  }
+
+  // 脏节点的祖先一定也是脏的，遇到脏的祖先即可停止
+  void mark_dirty( NodeId id )
+  {
+    for ( NodeId n = id; n != kInvalidNode && !hash_dirty_[ n ]; n = nodes_[ n ].parent ) { hash_dirty_[ n ] = 1; }
+  }
+
+  std::vector<Node> nodes_;
+  std::string names_;
+  mutable std::vector<uint64_t> hashes_;
+  mutable std::vector<uint8_t> hash_dirty_;
+  uint64_t generation_ = 0;
+};
+
+// arena 节点的 FileSystemNode 视图
+// children() 第一次调用时为每个子节点创建视图并缓存，arena 添加节点后重新生成，
+// 因此 parallel_reduce、TreeWriter、diff_trees 等按 FileSystemNode 遍历的代码可以直接处理 arena。
+// 遍历期间不要修改 arena：重新生成会使之前返回的列表失效
+class FlatNodeView : public FileSystemNode
+{
+ public:
+  FlatNodeView( FlatFileSystem &fs, NodeId id )
+      : FileSystemNode( std::string( fs.get_name( id ) ) ), fs_( fs ), id_( id )
+  {
+  }
+
+  void print( int indent = 0 ) const override { fs_.print( id_, indent ); }
+  int get_size() const override { return static_cast<int>( fs_.get_size( id_ ) ); }
+  bool is_directory() const override { return fs_.is_directory( id_ ); }
+  uint64_t content_hash() const override { return fs_.content_hash( id_ ); }
+
+  const std::vector<std::shared_ptr<FileSystemNode>> &children() const override
+  {
+    const uint64_t generation = fs_.generation() + 1;  // 0 表示还没有生成过
+    if ( children_generation_.load( std::memory_order_acquire ) != generation ) {
+      // 并行遍历时多个线程可能同时第一次访问同一个视图
+      std::lock_guard<std::mutex> lock( children_mutex_ );
+      if ( children_generation_.load( std::memory_order_relaxed ) != generation ) {
+        children_.clear();
+        fs_.for_each_child( id_, [ this ]( NodeId c ) {
+          children_.push_back( std::make_shared<FlatNodeView>( fs_, c ) );
+        } );
+        children_generation_.store( generation, std::memory_order_release );
+      }
+    }
+    return children_;
+  }
+
+  // 把 node 所代表的整棵子树复制到 arena 中
+  void add( std::shared_ptr<FileSystemNode> node ) override { import( id_, *node ); }
+
+  NodeId id() const { return id_; }
+
+ private:
+  bool attachable() const override { return false; }
+
+  void import( NodeId parent, const FileSystemNode &node )
+  {
+    if ( const auto *view = dynamic_cast<const FlatNodeView *>( &node ) ) {
+      import_flat( parent, view->fs_, view->id_ );
+    } else if ( const auto *dir = dynamic_cast<const Directory *>( &node ) ) {
+      const NodeId copy = fs_.add_directory( parent, dir->get_name() );
+      for ( const auto &child : dir->children() ) { import( copy, *child ); }
+    } else {
+      fs_.add_file( parent, node.get_name(), node.get_size() );
+    }
+  }
+
+  void import_flat( NodeId parent, const FlatFileSystem &src, NodeId id )
+  {
+    // 先记录整棵源子树再开始复制：src 可能就是 fs_，副本甚至可能加在源子树内部
+    std::vector<std::pair<NodeId, int>> order;
+    src.walk( id, [ &order ]( NodeId node, int depth ) { order.emplace_back( node, depth ); } );
+    std::vector<NodeId> copies{ parent };  // copies[ d ] 为深度 d 的节点应挂到的目录
+    for ( const auto &[ node, depth ] : order ) {
+      copies.resize( static_cast<size_t>( depth ) + 1 );
+      const std::string name( src.get_name( node ) );
+      if ( src.is_directory( node ) ) {
+        copies.push_back( fs_.add_directory( copies[ depth ], name ) );
+      } else {
+        fs_.add_file( copies[ depth ], name, src.get_size( node ) );
+      }
+    }
+  }
+
+  FlatFileSystem &fs_;
+  NodeId id_;
+  mutable std::vector<std::shared_ptr<FileSystemNode>> children_;
+  mutable std::atomic<uint64_t> children_generation_{ 0 };
+  mutable std::mutex children_mutex_;
+};
+
+inline std::shared_ptr<FileSystemNode> FlatFileSystem::view( NodeId id )
+{
+  return std::make_shared<FlatNodeView>( *this, id );
+}
+
+}  // namespace DesignPatterns::Composite
+
+#endif  // DESIGN_PATTERNS_STRUCTURAL_FLAT_COMPOSITE_H
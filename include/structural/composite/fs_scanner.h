@@ -0,0 +1,305 @@
+#ifndef DESIGN_PATTERNS_STRUCTURAL_FS_SCANNER_H
+#define DESIGN_PATTERNS_STRUCTURAL_FS_SCANNER_H
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "structural/composite/composite.h"
+
+namespace DesignPatterns::Composite
+{
+
+struct ScanOptions {
+  size_t threads       = std::max( 1u, std::thread::hardware_concurrency() );
+  bool follow_symlinks = false;  // 跟随时指向目录的符号链接会被展开，靠 inode 集合避免循环
+};
+
+struct ScanStats {
+  size_t files         = 0;
+  size_t directories   = 0;
+  size_t hardlinks     = 0;  // 重复出现的硬链接，节点保留但大小记为 0
+  size_t loops         = 0;  // 已经访问过的目录（符号链接或绑定挂载造成的循环），不再展开
+  size_t errors        = 0;  // 无法打开或读取的目录和文件
+  size_t fd_limit_hits = 0;  // 打开目录时文件描述符耗尽（EMFILE / ENFILE）的次数，之后改为按路径重新打开
+};
+
+// 从磁盘上的目录构建组合树
+// 多个工作线程从共享的目录栈中取目录，用 openat + getdents64 一次读一大块目录项，再用 fstatat 取大小；
+// 子目录相对父目录的文件描述符打开，不拼接完整路径，目录再深也不会遇到 ENAMETOOLONG，也不用每层重新解析整条路径；
+// 每个 Directory 只由读取它的线程填充，子目录创建后立即挂到父目录上并压栈，由任意线程继续读取。
+// 访问过的 (设备号, inode) 记录在分片加锁的集合中，硬链接只计一次大小，目录不会被重复展开
+class FileSystemScanner
+{
+ public:
+  explicit FileSystemScanner( ScanOptions options = {} ) : options_( options )
+  {
+    options_.threads = std::max<size_t>( options_.threads, 1 );
+  }
+
+  std::shared_ptr<Directory> scan( const std::filesystem::path &root )
+  {
+    struct stat st{};
+    if ( ::stat( root.c_str(), &st ) != 0 || !S_ISDIR( st.st_mode ) ) {
+      throw std::runtime_error( "FileSystemScanner: not a directory: " + root.string() );
+    }
+    stats_ = {};
+    for ( auto &shard : seen_ ) { shard.inodes.clear(); }
+    counters_.reset();
+
+    auto tree  = std::make_shared<Directory>( root.filename().empty() ? root.string() : root.filename().string() );
+    root_path_ = root.string();
+    root_node_ = tree.get();
+    markSeen( st.st_dev, st.st_ino );
+    counters_.directories.fetch_add( 1, std::memory_order_relaxed );
+    pending_.store( 1, std::memory_order_relaxed );
+    stack_.push_back( { nullptr, root.string(), tree.get() } );
+
+    {
+      std::vector<std::jthread> workers;
+      for ( size_t t = 1; t < options_.threads; ++t ) { workers.emplace_back( [ this ]() { work(); } ); }
+      work();
+    }  // jthread 析构时自动 join
+
+    stats_.files         = counters_.files.load();
+    stats_.directories   = counters_.directories.load();
+    stats_.hardlinks     = counters_.hardlinks.load();
+    stats_.loops         = counters_.loops.load();
+    stats_.errors        = counters_.errors.load();
+    stats_.fd_limit_hits = counters_.fd_limit_hits.load();
+    return tree;
+  }
+
+  const ScanStats &stats() const { return stats_; }
+
+ private:
+  // 已打开的目录描述符，最后一个待读的子目录打开后关闭。
+  // 宽而深的目录树里待读的子目录可能同时持有很多父目录的描述符，耗尽时由 openDirectory 统一放弃
+  struct DirFd {
+    explicit DirFd( int f ) : fd( f ) {}
+    DirFd( const DirFd & )            = delete;
+    DirFd &operator=( const DirFd & ) = delete;
+    ~DirFd() { ::close( fd ); }
+    int fd;
+  };
+
+  struct PendingDir {
+    std::shared_ptr<const DirFd> parent;  // 为空时按路径打开（根目录，或描述符耗尽后被放弃）
+    std::string name;
+    Directory *node;
+  };
+
+  struct InodeKey {
+    uint64_t dev;
+    uint64_t ino;
+    bool operator==( const InodeKey & ) const = default;
+  };
+
+  struct InodeHash {
+    size_t operator()( const InodeKey &k ) const
+    {
+      return std::hash<uint64_t>{}( k.ino * 0x9e3779b97f4a7c15ull ^ k.dev );
+    }
+  };
+
+  struct alignas( 64 ) InodeShard {
+    std::mutex mutex;
+    std::unordered_set<InodeKey, InodeHash> inodes;
+  };
+
+  struct Counters {
+    std::atomic<size_t> files{ 0 };
+    std::atomic<size_t> directories{ 0 };
+    std::atomic<size_t> hardlinks{ 0 };
+    std::atomic<size_t> loops{ 0 };
+    std::atomic<size_t> errors{ 0 };
+    std::atomic<size_t> fd_limit_hits{ 0 };
+
+    void reset()
+    {
+      for ( auto *c : { &files, &directories, &hardlinks, &loops, &errors, &fd_limit_hits } ) { c->store( 0 ); }
+    }
+  };
+
+  // 第一次见到返回 true
+  bool markSeen( dev_t dev, ino_t ino )
+  {
+    const InodeKey key{ static_cast<uint64_t>( dev ), static_cast<uint64_t>( ino ) };
+    InodeShard &shard = seen_[ InodeHash{}( key ) % kShards ];
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    return shard.inodes.insert( key ).second;
+  }
+
+  void work()
+  {
+    std::vector<char> buffer( 1 << 16 );
+    for ( ;; ) {
+      PendingDir dir;
+      {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        ready_.wait( lock, [ this ]() { return !stack_.empty() || pending_.load() == 0; } );
+        if ( stack_.empty() ) { return; }  // 所有目录都已读完
+        dir = std::move( stack_.back() );
+        stack_.pop_back();
+      }
+      readDirectory( dir, buffer );
+      if ( pending_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        ready_.notify_all();
+      }
+    }
+  }
+
+  // 打开待读的目录。描述符耗尽时，让栈里所有待读目录放弃父目录的描述符（没有别人持有的随之关闭），再按路径重新打开
+  int openDirectory( PendingDir &dir )
+  {
+    if ( dir.parent ) {
+      const int fd = ::openat( dir.parent->fd, dir.name.c_str(), kOpenFlags );
+      if ( fd >= 0 || ( errno != EMFILE && errno != ENFILE ) ) { return fd; }
+    } else {
+      const int fd = openByPath( dir.node );
+      if ( fd >= 0 || ( errno != EMFILE && errno != ENFILE ) ) { return fd; }
+    }
+    counters_.fd_limit_hits.fetch_add( 1, std::memory_order_relaxed );
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      for ( auto &pending : stack_ ) { pending.parent.reset(); }
+    }
+    dir.parent.reset();
+    return openByPath( dir.node );
+  }
+
+  // 从根目录开始拼出路径再打开；路径超过 PATH_MAX 时从根目录逐层 openat，同一时刻最多占用两个描述符
+  int openByPath( const FileSystemNode *node ) const
+  {
+    std::vector<const std::string *> names;
+    for ( ; node != root_node_; node = node->get_parent() ) { names.push_back( &node->get_name() ); }
+
+    std::string path = root_path_;
+    for ( auto it = names.rbegin(); it != names.rend(); ++it ) {
+      path += '/';
+      path += **it;
+    }
+    if ( path.size() < PATH_MAX ) { return ::open( path.c_str(), kOpenFlags ); }
+
+    int fd = ::open( root_path_.c_str(), kOpenFlags );
+    for ( auto it = names.rbegin(); it != names.rend() && fd >= 0; ++it ) {
+      const int next  = ::openat( fd, ( *it )->c_str(), kOpenFlags );
+      const int saved = errno;
+      ::close( fd );
+      errno = saved;
+      fd    = next;
+    }
+    return fd;
+  }
+
+  void readDirectory( PendingDir &dir, std::vector<char> &buffer )
+  {
+    const int fd = openDirectory( dir );
+    if ( fd < 0 ) {
+      counters_.errors.fetch_add( 1, std::memory_order_relaxed );
+      return;
+    }
+    dir.parent.reset();  // 打开之后就不再需要父目录的描述符
+    auto self = std::make_shared<const DirFd>( fd );
+    std::vector<PendingDir> subdirs;
+    for ( ;; ) {
+      const long n = ::syscall( SYS_getdents64, fd, buffer.data(), buffer.size() );
+      if ( n < 0 ) { counters_.errors.fetch_add( 1, std::memory_order_relaxed ); }
+      if ( n <= 0 ) { break; }
+      for ( long off = 0; off < n; ) {
+        const char *record = buffer.data() + off;
+        unsigned short reclen;
+        std::memcpy( &reclen, record + kReclenOffset, sizeof( reclen ) );
+        off += reclen;
+        const char *name = record + kNameOffset;
+        if ( name[ 0 ] == '.' && ( name[ 1 ] == '\0' || ( name[ 1 ] == '.' && name[ 2 ] == '\0' ) ) ) { continue; }
+        addEntry( self, dir, name, subdirs );
+      }
+    }
+
+    if ( !subdirs.empty() ) {
+      pending_.fetch_add( subdirs.size(), std::memory_order_relaxed );
+      std::lock_guard<std::mutex> lock( mutex_ );
+      for ( auto &sub : subdirs ) { stack_.push_back( std::move( sub ) ); }
+      ready_.notify_all();
+    }
+  }
+
+  void addEntry( const std::shared_ptr<const DirFd> &self, const PendingDir &dir, const char *name,
+                 std::vector<PendingDir> &subdirs )
+  {
+    const int dirfd = self->fd;
+    struct stat st{};
+    if ( ::fstatat( dirfd, name, &st, AT_SYMLINK_NOFOLLOW ) != 0 ) {
+      counters_.errors.fetch_add( 1, std::memory_order_relaxed );
+      return;
+    }
+    if ( S_ISLNK( st.st_mode ) && options_.follow_symlinks ) {
+      struct stat target{};
+      if ( ::fstatat( dirfd, name, &target, 0 ) == 0 ) { st = target; }  // 悬空链接按链接本身处理
+    }
+
+    if ( S_ISDIR( st.st_mode ) ) {
+      if ( !markSeen( st.st_dev, st.st_ino ) ) {
+        counters_.loops.fetch_add( 1, std::memory_order_relaxed );
+        dir.node->add( std::make_shared<Directory>( name ) );
+        return;
+      }
+      auto sub = std::make_shared<Directory>( name );
+      dir.node->add( sub );
+      counters_.directories.fetch_add( 1, std::memory_order_relaxed );
+      subdirs.push_back( { self, name, sub.get() } );
+      return;
+    }
+
+    int size_kb = static_cast<int>( ( st.st_size + 1023 ) / 1024 );
+    if ( st.st_nlink > 1 && !markSeen( st.st_dev, st.st_ino ) ) {
+      counters_.hardlinks.fetch_add( 1, std::memory_order_relaxed );
+      size_kb = 0;
+    }
+    dir.node->add( std::make_shared<File>( name, size_kb ) );
+    counters_.files.fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  // getdents64 返回的 linux_dirent64：u64 d_ino, s64 d_off, u16 d_reclen, u8 d_type, char d_name[]
+  static constexpr size_t kReclenOffset = 16;
+  static constexpr size_t kNameOffset   = 19;
+  static constexpr size_t kShards       = 64;
+  static constexpr int kOpenFlags       = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+
+  ScanOptions options_;
+  ScanStats stats_;
+  Counters counters_;
+  std::string root_path_;
+  const FileSystemNode *root_node_ = nullptr;
+  std::array<InodeShard, kShards> seen_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::vector<PendingDir> stack_;      // 后进先出，深度优先，待读目录的数量保持在较低水平
+  std::atomic<size_t> pending_{ 0 };  // 已入栈但还没读完的目录数，归零时扫描结束
+};
+
+}  // namespace DesignPatterns::Composite
+
+#endif  // DESIGN_PATTERNS_STRUCTURAL_FS_SCANNER_H
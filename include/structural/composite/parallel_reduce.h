@@ -0,0 +1,239 @@
+#ifndef DESIGN_PATTERNS_STRUCTURAL_PARALLEL_REDUCE_H
+#define DESIGN_PATTERNS_STRUCTURAL_PARALLEL_REDUCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "structural/composite/composite.h"
+
+namespace DesignPatterns::Composite
+{
+
+// 简单的 fork-join 线程池
+// fork() 把任务放入共享队列，空闲的工作线程从队头取走最早（通常也是最大）的任务；
+// join() 在等待期间从队尾取任务来执行，所以调用线程也参与计算，嵌套的 fork / join 不会因为线程耗尽而死锁。
+// 任务先被谁认领就由谁执行，join 的任务如果还没被取走，就直接在调用线程上执行
+class ForkJoinPool
+{
+ public:
+  class Task
+  {
+    friend class ForkJoinPool;
+    std::function<void()> fn;
+    std::atomic<bool> claimed{ false };
+    std::atomic<bool> done{ false };
+    std::exception_ptr error;
+  };
+  using Handle = std::shared_ptr<Task>;
+
+  // threads 包括调用 join 的线程在内，只额外创建 threads - 1 个工作线程
+  explicit ForkJoinPool( size_t threads = std::thread::hardware_concurrency() )
+  {
+    threads_ = std::max<size_t>( threads, 1 );
+    for ( size_t i = 1; i < threads_; ++i ) {
+      workers_.emplace_back( [ this ]( std::stop_token token ) { run( token ); } );
+    }
+  }
+
+  ForkJoinPool( const ForkJoinPool & )            = delete;
+  ForkJoinPool &operator=( const ForkJoinPool & ) = delete;
+
+  ~ForkJoinPool()
+  {
+    for ( auto &w : workers_ ) { w.request_stop(); }
+    ready_.notify_all();
+  }  // jthread 析构时自动 join
+
+  size_t threads() const { return threads_; }
+
+  Handle fork( std::function<void()> fn )
+  {
+    auto task = std::make_shared<Task>();
+    task->fn  = std::move( fn );
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      queue_.push_back( task );
+    }
+    ready_.notify_one();
+    return task;
+  }
+
+  // 等待任务完成，任务抛出的异常在这里重新抛出
+  void join( const Handle &task )
+  {
+    if ( !tryRun( *task ) ) {
+      while ( !task->done.load( std::memory_order_acquire ) ) {
+        if ( Handle other = pop( false ) ) {
+          tryRun( *other );
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+    if ( task->error ) { std::rethrow_exception( task->error ); }
+  }
+
+ private:
+  static bool tryRun( Task &task )
+  {
+    if ( task.claimed.exchange( true, std::memory_order_acq_rel ) ) { return false; }
+    try {
+      task.fn();
+    } catch ( ... ) {
+      task.error = std::current_exception();
+    }
+    task.done.store( true, std::memory_order_release );
+    return true;
+  }
+
+  Handle pop( bool front )
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    if ( queue_.empty() ) { return nullptr; }
+    Handle task;
+    if ( front ) {
+      task = std::move( queue_.front() );
+      queue_.pop_front();
+    } else {
+      task = std::move( queue_.back() );
+      queue_.pop_back();
+    }
+    return task;
+  }
+
+  void run( std::stop_token token )
+  {
+    for ( ;; ) {
+      Handle task;
+      {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        ready_.wait( lock, token, [ this ]() { return !queue_.empty(); } );
+        if ( queue_.empty() ) { return; }
+        task = std::move( queue_.front() );
+        queue_.pop_front();
+      }
+      tryRun( *task );
+    }
+  }
+
+  size_t threads_;
+  std::mutex mutex_;
+  std::condition_variable_any ready_;
+  std::deque<Handle> queue_;
+  std::vector<std::jthread> workers_;
+};
+
+struct ReduceOptions {
+  size_t grain        = 1024;  // 只有叶子的兄弟区间少于这么多个节点时不再拆分
+  int max_split_depth = 10;    // 每条路径上最多拆分的次数，任务总数不超过 2^max_split_depth
+};
+
+namespace detail
+{
+
+template <typename T, typename Map, typename Combine>
+struct TreeReducer {
+  using Children = std::vector<std::shared_ptr<FileSystemNode>>;
+
+  ForkJoinPool &pool;
+  const T &identity;
+  Map &map;
+  Combine &combine;
+  const ReduceOptions &options;
+
+  T node( const FileSystemNode &n, int depth, int budget )
+  {
+    T acc                = map( n, depth );
+    const Children &kids = n.children();
+    if ( kids.empty() ) { return acc; }
+    return combine( std::move( acc ), range( kids, 0, kids.size(), depth + 1, budget ) );
+  }
+
+  T range( const Children &kids, size_t begin, size_t end, int depth, int budget )
+  {
+    if ( end - begin == 1 ) { return node( *kids[ begin ], depth, budget ); }
+    if ( budget > 0 && heavy( kids, begin, end ) ) {
+      const size_t mid = begin + ( end - begin ) / 2;
+      T left           = identity;
+      auto task = pool.fork( [ &, begin, mid ]() { left = range( kids, begin, mid, depth, budget - 1 ); } );
+      T right   = identity;
+      try {
+        right = range( kids, mid, end, depth, budget - 1 );
+      } catch ( ... ) {
+        // 左半边引用着当前栈帧，必须等它结束后才能把异常继续抛出去
+        try {
+          pool.join( task );
+        } catch ( ... ) {
+        }
+        throw;
+      }
+      pool.join( task );
+      return combine( std::move( left ), std::move( right ) );
+    }
+    T acc = identity;
+    for ( size_t i = begin; i < end; ++i ) { acc = combine( std::move( acc ), node( *kids[ i ], depth, budget ) ); }
+    return acc;
+  }
+
+  // 区间足够大，或者其中有目录（子树大小未知）时才值得拆分
+  bool heavy( const Children &kids, size_t begin, size_t end ) const
+  {
+    if ( end - begin >= options.grain ) { return true; }
+    return std::any_of( kids.begin() + static_cast<std::ptrdiff_t>( begin ),
+                        kids.begin() + static_cast<std::ptrdiff_t>( end ),
+                        []( const auto &child ) { return !child->children().empty(); } );
+  }
+};
+
+}  // namespace detail
+
+// 在组合树上做并行归约
+// 每个节点的值为 map( node, depth )，再按子节点的顺序用 combine 与子树的结果合并。
+// 拆分位置只取决于树的形状和 options，与线程数和调度无关，所以对满足结合律的 combine，结果与串行完全一致，
+// 拼接字符串这类不满足交换律的归约也能得到确定的顺序
+template <typename T, typename Map, typename Combine>
+T parallel_reduce( ForkJoinPool &pool, const FileSystemNode &root, T identity, Map map, Combine combine,
+                   const ReduceOptions &options = {} )
+{
+  detail::TreeReducer<T, Map, Combine> reducer{ pool, identity, map, combine, options };
+  return reducer.node( root, 0, options.max_split_depth );
+}
+
+// 常用的几种归约
+inline int64_t parallel_total_size( ForkJoinPool &pool, const FileSystemNode &root, const ReduceOptions &options = {} )
+{
+  return parallel_reduce(
+      pool, root, int64_t( 0 ),
+      []( const FileSystemNode &n, int ) { return n.children().empty() ? int64_t( n.get_size() ) : int64_t( 0 ); },
+      []( int64_t a, int64_t b ) { return a + b; }, options );
+}
+
+inline size_t parallel_node_count( ForkJoinPool &pool, const FileSystemNode &root, const ReduceOptions &options = {} )
+{
+  return parallel_reduce(
+      pool, root, size_t( 0 ), []( const FileSystemNode &, int ) { return size_t( 1 ); },
+      []( size_t a, size_t b ) { return a + b; }, options );
+}
+
+inline int parallel_max_depth( ForkJoinPool &pool, const FileSystemNode &root, const ReduceOptions &options = {} )
+{
+  return parallel_reduce(
+      pool, root, 0, []( const FileSystemNode &, int depth ) { return depth; },
+      []( int a, int b ) { return std::max( a, b ); }, options );
+}
+
+}  // namespace DesignPatterns::Composite
+
+#endif  // DESIGN_PATTERNS_STRUCTURAL_PARALLEL_REDUCE_H
@@ -0,0 +1,84 @@
+#ifndef DESIGN_PATTERNS_STRUCTURAL_TREE_DIFF_H
+#define DESIGN_PATTERNS_STRUCTURAL_TREE_DIFF_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "structural/composite/composite.h"
+
+namespace DesignPatterns::Composite
+{
+
+struct TreeChange {
+  enum class Kind { Added, Removed, Modified };
+
+  Kind kind;
+  std::string path;              // 相对于比较的根，用 '/' 分隔
+  const FileSystemNode *before;  // Added 时为 nullptr
+  const FileSystemNode *after;   // Removed 时为 nullptr
+};
+
+namespace detail
+{
+
+inline std::string join_path( const std::string &parent, const std::string &name )
+{
+  return parent.empty() ? name : parent + "/" + name;
+}
+
+inline void diff_nodes( const FileSystemNode &a, const FileSystemNode &b, const std::string &path,
+                        std::vector<TreeChange> &changes )
+{
+  if ( a.content_hash() == b.content_hash() ) { return; }  // 相同的子树整体跳过
+  if ( !a.is_directory() || !b.is_directory() ) {
+    changes.push_back( { TreeChange::Kind::Modified, path, &a, &b } );
+    return;
+  }
+
+  // 子节点按名字配对，只在哈希不同的目录里建索引；同名的子节点优先与哈希相同的配对
+  std::unordered_multimap<std::string_view, const FileSystemNode *> after;
+  after.reserve( b.children().size() );
+  for ( const auto &child : b.children() ) { after.emplace( child->get_name(), child.get() ); }
+  for ( const auto &child : a.children() ) {
+    auto [ first, last ] = after.equal_range( child->get_name() );
+    if ( first == last ) {
+      changes.push_back( { TreeChange::Kind::Removed, join_path( path, child->get_name() ), child.get(), nullptr } );
+      continue;
+    }
+    auto match = first;
+    for ( auto it = first; it != last; ++it ) {
+      if ( it->second->content_hash() == child->content_hash() ) {
+        match = it;
+        break;
+      }
+    }
+    const FileSystemNode *other = match->second;
+    after.erase( match );
+    diff_nodes( *child, *other, join_path( path, child->get_name() ), changes );
+  }
+  for ( const auto &child : b.children() ) {
+    auto [ first, last ] = after.equal_range( child->get_name() );
+    auto it = std::find_if( first, last, [ &child ]( const auto &entry ) { return entry.second == child.get(); } );
+    if ( it != last ) {
+      changes.push_back( { TreeChange::Kind::Added, join_path( path, child->get_name() ), nullptr, child.get() } );
+    }
+  }
+}
+
+}  // namespace detail
+
+// 比较两棵树，返回从 before 到 after 的变化
+// 哈希相同的子树直接跳过，开销与 变化数 × 深度 × 变化路径上目录的宽度 成正比，而不是整棵树的大小
+inline std::vector<TreeChange> diff_trees( const FileSystemNode &before, const FileSystemNode &after )
+{
+  std::vector<TreeChange> changes;
+  detail::diff_nodes( before, after, "", changes );
+  return changes;
+}
+
+}  // namespace DesignPatterns::Composite
+
+#endif  // DESIGN_PATTERNS_STRUCTURAL_TREE_DIFF_H
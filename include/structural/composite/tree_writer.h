@@ -0,0 +1,315 @@
+#ifndef DESIGN_PATTERNS_STRUCTURAL_TREE_WRITER_H
+#define DESIGN_PATTERNS_STRUCTURAL_TREE_WRITER_H
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "structural/composite/composite.h"
+#include "structural/composite/flat_composite.h"
+
+namespace DesignPatterns::Composite
+{
+
+enum class TreeFormat {
+  Text,    // 与 print() 相同的缩进文本
+  Json,    // 一个嵌套的 JSON 对象，目录的 size 写在 children 之后
+  Ndjson,  // 每个节点一行，先序，包含完整路径；目录不带 size
+};
+
+// 组合树的流式输出
+// 先序深度优先遍历，只保存当前路径上的栈帧，内存与树的深度成正比；输出先写入一块可复用的缓冲区，
+// 满了才交给 sink，数字和缩进都自己格式化，不经过 iostream。目录的大小在遍历过程中由子节点累加，
+// 指针树上也不会反复调用 get_size()
+class TreeWriter
+{
+ public:
+  using Sink = std::function<void( const char *data, size_t size )>;
+
+  explicit TreeWriter( Sink sink, size_t buffer_size = size_t( 1 ) << 16 )
+      : sink_( std::move( sink ) ), buffer_( std::max<size_t>( buffer_size, 64 ) )
+  {
+  }
+
+  // 写入 std::ostream
+  explicit TreeWriter( std::ostream &out, size_t buffer_size = size_t( 1 ) << 16 )
+      : TreeWriter(
+            [ &out ]( const char *data, size_t size ) { out.write( data, static_cast<std::streamsize>( size ) ); },
+            buffer_size )
+  {
+  }
+
+  // 直接写入文件描述符
+  static TreeWriter to_fd( int fd, size_t buffer_size = size_t( 1 ) << 16 )
+  {
+    return TreeWriter(
+        [ fd ]( const char *data, size_t size ) {
+          while ( size > 0 ) {
+            const ssize_t n = ::write( fd, data, size );
+            if ( n < 0 ) {
+              if ( errno == EINTR ) { continue; }
+              throw std::runtime_error( "TreeWriter: write failed" );
+            }
+            data += n;
+            size -= static_cast<size_t>( n );
+          }
+        },
+        buffer_size );
+  }
+
+  TreeWriter( TreeWriter && )            = default;
+  TreeWriter &operator=( TreeWriter && ) = delete;
+
+  ~TreeWriter()
+  {
+    try {
+      flush();
+    } catch ( ... ) {
+    }
+  }
+
+  void write( const FileSystemNode &root, TreeFormat format )
+  {
+    PointerTree tree;
+    emit( tree, &root, format );
+  }
+
+  void write( const FlatFileSystem &fs, NodeId root, TreeFormat format )
+  {
+    FlatTree tree{ fs };
+    emit( tree, root, format );
+  }
+
+  void flush()
+  {
+    if ( used_ > 0 ) {
+      sink_( buffer_.data(), used_ );
+      written_ += used_;
+      used_ = 0;
+    }
+  }
+
+  // 已经交给 sink 的字节数
+  size_t bytes_written() const { return written_; }
+
+ private:
+  // 两种树的统一访问方式
+  struct PointerTree {
+    using Node   = const FileSystemNode *;
+    using Cursor = size_t;
+
+    bool is_directory( Node n ) const { return n->is_directory(); }
+    std::string_view name( Node n ) const { return n->get_name(); }
+    int64_t file_size( Node n ) const { return n->get_size(); }
+    Cursor first( Node ) const { return 0; }
+    bool next( Node n, Cursor &c, Node &child ) const
+    {
+      const auto &children = n->children();
+      if ( c >= children.size() ) { return false; }
+      child = children[ c++ ].get();
+      return true;
+    }
+  };
+
+  struct FlatTree {
+    using Node   = NodeId;
+    using Cursor = NodeId;
+
+    const FlatFileSystem &fs;
+
+    bool is_directory( Node n ) const { return fs.is_directory( n ); }
+    std::string_view name( Node n ) const { return fs.get_name( n ); }
+    int64_t file_size( Node n ) const { return fs.get_size( n ); }
+    Cursor first( Node n ) const { return fs.first_child( n ); }
+    bool next( Node, Cursor &c, Node &child ) const
+    {
+      if ( c == kInvalidNode ) { return false; }
+      child = c;
+      c     = fs.next_sibling( c );
+      return true;
+    }
+  };
+
+  template <typename Tree>
+  struct Frame {
+    typename Tree::Node node;
+    typename Tree::Cursor cursor;
+    int64_t size;
+    size_t path_length;  // 进入该目录前路径的长度（仅 NDJSON）
+    bool has_children;
+  };
+
+  template <typename Tree>
+  void emit( const Tree &tree, typename Tree::Node root, TreeFormat format )
+  {
+    path_.clear();
+    std::vector<Frame<Tree>> stack;
+    int64_t root_size = 0;
+    if ( !open( tree, root, 0, format, nullptr, root_size ) ) {
+      stack.push_back( { root, tree.first( root ), 0, 0, false } );
+    }
+    while ( !stack.empty() ) {
+      Frame<Tree> &top = stack.back();
+      typename Tree::Node child;
+      if ( tree.next( top.node, top.cursor, child ) ) {
+        const bool first  = !top.has_children;
+        top.has_children  = true;
+        const size_t mark = path_.size();
+        int64_t file_size = 0;
+        if ( open( tree, child, static_cast<int>( stack.size() ), format, &first, file_size ) ) {
+          top.size += file_size;
+          path_.resize( mark );
+        } else {
+          stack.push_back( { child, tree.first( child ), 0, mark, false } );
+        }
+        continue;
+      }
+      const int64_t size = top.size;
+      path_.resize( top.path_length );
+      if ( format == TreeFormat::Json ) {
+        put( "],\"size\":" );
+        put_int( size );
+        put( '}' );
+      }
+      stack.pop_back();
+      if ( !stack.empty() ) { stack.back().size += size; }
+    }
+    if ( format == TreeFormat::Json ) { put( '\n' ); }
+  }
+
+  // 输出节点的开头；文件直接输出完整并返回 true，目录返回 false，由调用方压栈
+  template <typename Tree>
+  bool open( const Tree &tree, typename Tree::Node node, int depth, TreeFormat format, const bool *first,
+             int64_t &file_size )
+  {
+    const bool dir              = tree.is_directory( node );
+    const std::string_view name = tree.name( node );
+    if ( !dir ) { file_size = tree.file_size( node ); }
+
+    switch ( format ) {
+      case TreeFormat::Text:
+        put_spaces( static_cast<size_t>( depth ) * 2 );
+        if ( dir ) {
+          put( "+ Directory: " );
+          put( name );
+          put( '\n' );
+        } else {
+          put( "- File: " );
+          put( name );
+          put( " (" );
+          put_int( file_size );
+          put( " KB)\n" );
+        }
+        break;
+      case TreeFormat::Json:
+        if ( first && !*first ) { put( ',' ); }
+        put( "{\"name\":" );
+        put_json_string( name );
+        if ( dir ) {
+          put( ",\"type\":\"directory\",\"children\":[" );
+        } else {
+          put( ",\"type\":\"file\",\"size\":" );
+          put_int( file_size );
+          put( '}' );
+        }
+        break;
+      case TreeFormat::Ndjson:
+        if ( !path_.empty() ) { path_.push_back( '/' ); }
+        path_.append( name );
+        put( "{\"path\":" );
+        put_json_string( path_ );
+        put( dir ? ",\"type\":\"directory\",\"depth\":" : ",\"type\":\"file\",\"depth\":" );
+        put_int( depth );
+        if ( !dir ) {
+          put( ",\"size\":" );
+          put_int( file_size );
+        }
+        put( "}\n" );
+        break;
+    }
+    return !dir;
+  }
+
+  void put( char c )
+  {
+    if ( used_ == buffer_.size() ) { flush(); }
+    buffer_[ used_++ ] = c;
+  }
+
+  void put( std::string_view s )
+  {
+    if ( s.size() > buffer_.size() - used_ ) {
+      flush();
+      if ( s.size() > buffer_.size() ) {
+        sink_( s.data(), s.size() );
+        written_ += s.size();
+        return;
+      }
+    }
+    std::memcpy( buffer_.data() + used_, s.data(), s.size() );
+    used_ += s.size();
+  }
+
+  void put_int( int64_t v )
+  {
+    char digits[ 24 ];
+    const auto result = std::to_chars( digits, digits + sizeof( digits ), v );
+    put( std::string_view( digits, static_cast<size_t>( result.ptr - digits ) ) );
+  }
+
+  void put_spaces( size_t n )
+  {
+    static constexpr char kSpaces[] = "                                                                ";
+    while ( n > 0 ) {
+      const size_t chunk = std::min( n, sizeof( kSpaces ) - 1 );
+      put( std::string_view( kSpaces, chunk ) );
+      n -= chunk;
+    }
+  }
+
+  void put_json_string( std::string_view s )
+  {
+    put( '"' );
+    size_t plain = 0;  // 不需要转义的一段连续字符整体写入
+    for ( size_t i = 0; i < s.size(); ++i ) {
+      const auto c = static_cast<unsigned char>( s[ i ] );
+      if ( c >= 0x20 && c != '"' && c != '\\' ) { continue; }
+      put( s.substr( plain, i - plain ) );
+      plain = i + 1;
+      switch ( c ) {
+        case '"': put( "\\\"" ); break;
+        case '\\': put( "\\\\" ); break;
+        case '\n': put( "\\n" ); break;
+        case '\t': put( "\\t" ); break;
+        default: {
+          static constexpr char kHex[] = "0123456789abcdef";
+          const char escaped[]         = { '\\', 'u', '0', '0', kHex[ c >> 4 ], kHex[ c & 0xf ] };
+          put( std::string_view( escaped, sizeof( escaped ) ) );
+        }
+      }
+    }
+    put( s.substr( plain ) );
+    put( '"' );
+  }
+
+  Sink sink_;
+  std::vector<char> buffer_;
+  size_t used_    = 0;
+  size_t written_ = 0;
+  std::string path_;  // NDJSON 的当前路径
+};
+
+}  // namespace DesignPatterns::Composite
+
+#endif  // DESIGN_PATTERNS_STRUCTURAL_TREE_WRITER_H
@@ -0,0 +1,81 @@
+#ifndef INCLUDE_STRUCTURAL_FLYWEIGHT_COMPACT_FOREST_H
+#define INCLUDE_STRUCTURAL_FLYWEIGHT_COMPACT_FOREST_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "structural/flyweight/flyweight.h"
+
+namespace DesignPatterns::Flyweight
+{
+
+// 紧凑的森林：外部状态按列存放（x、y、类型句柄三个平行数组），每棵树 12 字节，
+// 种树时不再复制 shared_ptr，也就没有原子引用计数的开销
+class CompactForest
+{
+ public:
+  static constexpr size_t kBytesPerTree = sizeof( int ) * 2 + sizeof( TreeHandle );
+
+  explicit CompactForest( std::shared_ptr<TreeFactory> f ) : factory( std::move( f ) ) {}
+
+  void reserve( size_t n )
+  {
+    xs.reserve( n );
+    ys.reserve( n );
+    types.reserve( n );
+  }
+
+  void plantTree( int x, int y, std::string_view type, std::string_view color )
+  {
+    plantTree( x, y, factory->getHandle( type, color ) );
+  }
+
+  void plantTree( int x, int y, TreeHandle handle )
+  {
+    xs.push_back( x );
+    ys.push_back( y );
+    types.push_back( handle );
+  }
+
+  // 依次访问每棵树，fn( const Tree &, int x, int y )
+  // 先把句柄解析成指针表，遍历时只是一次数组下标
+  template <typename Fn>
+  void forEach( Fn &&fn ) const
+  {
+    const auto lut = resolve();
+    for ( size_t i = 0; i < xs.size(); ++i ) { fn( *lut[ types[ i ] ], xs[ i ], ys[ i ] ); }
+  }
+
+  void render() const
+  {
+    Singleton::log_info( "\n渲染森林中的所有树木 (", xs.size(), " 棵树, ", factory->getTreeTypesCount(), " 种类型):" );
+    forEach( []( const Tree &tree, int x, int y ) { tree.render( x, y ); } );
+  }
+
+  size_t size() const { return xs.size(); }
+  size_t memoryBytes() const { return xs.capacity() * sizeof( int ) * 2 + types.capacity() * sizeof( TreeHandle ); }
+
+  const std::vector<int> &xColumn() const { return xs; }
+  const std::vector<int> &yColumn() const { return ys; }
+  const std::vector<TreeHandle> &typeColumn() const { return types; }
+  const TreeFactory &getFactory() const { return *factory; }
+
+ private:
+  std::vector<const Tree *> resolve() const
+  {
+    std::vector<const Tree *> lut( factory->getTreeTypesCount() );
+    for ( size_t i = 0; i < lut.size(); ++i ) { lut[ i ] = &factory->getTree( static_cast<TreeHandle>( i ) ); }
+    return lut;
+  }
+
+  std::shared_ptr<TreeFactory> factory;
+  std::vector<int> xs;
+  std::vector<int> ys;
+  std::vector<TreeHandle> types;
+};
+
+}  // namespace DesignPatterns::Flyweight
+
+#endif  // INCLUDE_STRUCTURAL_FLYWEIGHT_COMPACT_FOREST_H
@@ -1,12 +1,21 @@
 #ifndef INCLUDE_STRUCTURAL_FLYWEIGHT_FLYWEIGHT_H
 #define INCLUDE_STRUCTURAL_FLYWEIGHT_FLYWEIGHT_H
 
-#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <string>
-#include <map>
+#include <string_view>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "creational/singleton/logger.h"
+
+#include "structural/flyweight/intern_pool.h"
+#include "structural/flyweight/model_loader.h"
+
 namespace DesignPatterns::Flyweight
 {
 
@@ -19,50 +28,118 @@ class GameObject
 };
 
 // 树的享元对象 - 内部状态是树的类型和颜色
+// 模型数据可以在后台加载：模型就绪之前渲染使用占位模型，调用方也可以轮询 isLoaded() 或用 waitLoaded() 等待
 class Tree : public GameObject
 {
  private:
-  std::string type;   // 内部状态
-  std::string color;  // 内部状态
-  std::string model;  // 内部状态（复杂对象）
+  std::string type;                       // 内部状态
+  std::string color;                      // 内部状态
+  std::shared_future<std::string> model;  // 内部状态（复杂对象），可能尚未加载完成
 
  public:
-  Tree( const std::string &t, const std::string &c ) : type( t ), color( c )
+  static constexpr const char *kPlaceholderModel = "占位模型";
+
+  // 模拟加载复杂模型数据
+  static std::string loadModel( const std::string &type, const std::string & )
   {
-    // 模拟加载复杂模型数据
-    model = "加载了" + type + "的3D模型数据...";
-    std::cout << "创建新的树类型: " << type << std::endl;
+    return "加载了" + type + "的3D模型数据...";
+  }
+
+  // 已经就绪的模型
+  static std::shared_future<std::string> readyModel( std::string m )
+  {
+    std::promise<std::string> promise;
+    promise.set_value( std::move( m ) );
+    return promise.get_future().share();
+  }
+
+  // 同步加载模型
+  Tree( const std::string &t, const std::string &c ) : Tree( t, c, readyModel( loadModel( t, c ) ) ) {}
+
+  // 模型由 future 提供，通常来自 ModelLoader
+  Tree( const std::string &t, const std::string &c, std::shared_future<std::string> m )
+      : type( t ), color( c ), model( std::move( m ) )
+  {
+    Singleton::log_info( "创建新的树类型: ", type );
   }
 
   void render( int x, int y ) const override
   {
-    std::cout << "在位置(" << x << "," << y << ")渲染" << color << "的" << type << " - " << model << std::endl;
+    Singleton::log_info( "在位置(", x, ",", y, ")渲染", color, "的", type, " - ", getModelOrPlaceholder() );
+  }
+
+  // 批量渲染同一种树的多个实例，模型数据只绑定一次
+  void renderBatch( const std::vector<std::pair<int, int>> &positions ) const
+  {
+    Singleton::log_info( "批量渲染", positions.size(), "棵", color, "的", type, " - ", getModelOrPlaceholder() );
   }
 
   const std::string &getType() const { return type; }
   const std::string &getColor() const { return color; }
+
+  // 加载结束（成功或失败）时返回 true
+  bool isLoaded() const { return model.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready; }
+  void waitLoaded() const { model.wait(); }
+
+  // 等待模型加载完成，加载失败时重新抛出加载函数的异常
+  const std::string &getModel() const { return model.get(); }
+
+  // 不等待：模型未就绪或加载失败时返回占位模型
+  std::string_view getModelOrPlaceholder() const
+  {
+    if ( !isLoaded() ) { return kPlaceholderModel; }
+    try {
+      return model.get();
+    } catch ( ... ) {
+      return kPlaceholderModel;
+    }
+  }
 };
 
+// 享元的紧凑句柄：工厂中树类型的编号
+using TreeHandle = uint32_t;
+
 // 树工厂 - 管理树的共享对象
+// 以 (类型, 颜色) 为键驻留在 InternPool 中：查找无锁且不构造临时字符串，可以被多个线程同时调用。
+// 配置了 ModelLoader 时，新类型的模型在后台加载，getTree 立即返回；同一个键只会创建一个 Tree，
+// 并发请求共享同一次加载
 class TreeFactory
 {
- private:
-  std::map<std::string, std::shared_ptr<Tree>> trees;
+ public:
+  using LoadFn = std::function<std::string( const std::string &type, const std::string &color )>;
 
-  std::string getKey( const std::string &type, const std::string &color ) const { return type + "_" + color; }
+  TreeFactory() = default;
 
- public:
-  std::shared_ptr<Tree> getTree( const std::string &type, const std::string &color )
+  explicit TreeFactory( std::shared_ptr<ModelLoader> l, LoadFn load = &Tree::loadModel )
+      : loader( std::move( l ) ), loadFn( std::move( load ) )
   {
-    std::string key = getKey( type, color );
+  }
 
-    if ( trees.find( key ) != trees.end() ) { return trees[ key ]; }
+ private:
+  InternPool<Tree> trees;
+  std::shared_ptr<ModelLoader> loader;
+  LoadFn loadFn = &Tree::loadModel;
 
-    auto newTree = std::make_shared<Tree>( type, color );
-    trees[ key ] = newTree;
-    return newTree;
+  const InternPool<Tree>::Entry &intern( std::string_view type, std::string_view color )
+  {
+    auto make = [ this, type, color ]() {
+      std::string t( type ), c( color );
+      if ( !loader ) { return std::make_shared<Tree>( t, c, Tree::readyModel( loadFn( t, c ) ) ); }
+      auto model = loader->submit( [ load = loadFn, t, c ]() { return load( t, c ); } );
+      return std::make_shared<Tree>( t, c, std::move( model ) );
+    };
+    return trees.intern( type, color, make );
   }
 
+ public:
+  std::shared_ptr<Tree> getTree( std::string_view type, std::string_view color ) { return intern( type, color ).value; }
+
+  // 返回 32 位句柄而不是 shared_ptr，适合大量存储
+  TreeHandle getHandle( std::string_view type, std::string_view color ) { return intern( type, color ).id; }
+
+  // 按句柄无锁取回树
+  const Tree &getTree( TreeHandle handle ) const { return *trees.at( handle ).value; }
+
   size_t getTreeTypesCount() const { return trees.size(); }
 };
 
@@ -86,11 +163,19 @@ class Forest
 
   void render() const
   {
-    std::cout << "\n渲染森林中的所有树木 (" << trees.size() << " 棵树, " << factory->getTreeTypesCount()
-              << " 种类型):\n";
+    Singleton::log_info( "\n渲染森林中的所有树木 (", trees.size(), " 棵树, ", factory->getTreeTypesCount(), " 种类型):" );
 
     for ( const auto &[ tree, position ] : trees ) { tree->render( position.first, position.second ); }
   }
+
+  // 依次访问每棵树，fn( const Tree &, int x, int y )
+  template <typename Fn>
+  void forEach( Fn &&fn ) const
+  {
+    for ( const auto &[ tree, position ] : trees ) { fn( *tree, position.first, position.second ); }
+  }
+
+  size_t size() const { return trees.size(); }
 };
 
 }  // namespace DesignPatterns::Flyweight
@@ -0,0 +1,159 @@
+#ifndef INCLUDE_STRUCTURAL_FLYWEIGHT_FOREST_GRID_H
+#define INCLUDE_STRUCTURAL_FLYWEIGHT_FOREST_GRID_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "structural/flyweight/compact_forest.h"
+
+namespace DesignPatterns::Flyweight
+{
+
+// 视口，闭区间
+struct Viewport {
+  int min_x;
+  int min_y;
+  int max_x;
+  int max_y;
+};
+
+// CompactForest 的均匀网格空间索引
+// 构建时用计数排序把树按所在格子排好（CSR 布局：每个格子对应 order 中连续的一段），查询只访问与视口相交的格子，
+// 完全落在视口内的格子不再逐棵判断。查询开销只与可见格子和可见的树有关，与森林大小无关
+class ForestGrid
+{
+ public:
+  explicit ForestGrid( const CompactForest &f, int cell = 64 )
+      : forest( f ), requested_cell( std::max( cell, 1 ) ), cell_size( requested_cell )
+  {
+    rebuild();
+  }
+
+  // 实际使用的格子边长
+  int cellSize() const { return cell_size; }
+
+  // 森林种了新树之后需要重建
+  void rebuild()
+  {
+    const auto &xs = forest.xColumn();
+    const auto &ys = forest.yColumn();
+    const size_t n = xs.size();
+    if ( n == 0 ) {
+      cols = rows = 0;
+      cell_start.assign( 1, 0 );
+      order.clear();
+      return;
+    }
+
+    const auto [ min_x, max_x ] = std::minmax_element( xs.begin(), xs.end() );
+    const auto [ min_y, max_y ] = std::minmax_element( ys.begin(), ys.end() );
+    origin_x                    = *min_x;
+    origin_y                    = *min_y;
+    // 格子数不超过树的数量，森林稀疏时自动放大格子，索引大小始终与树的数量成正比
+    cell_size = requested_cell;
+    for ( ;; ) {
+      cols = static_cast<size_t>( ( static_cast<long long>( *max_x ) - origin_x ) / cell_size ) + 1;
+      rows = static_cast<size_t>( ( static_cast<long long>( *max_y ) - origin_y ) / cell_size ) + 1;
+      if ( cols * rows <= n || cell_size > std::numeric_limits<int>::max() / 2 ) { break; }
+      cell_size *= 2;
+    }
+
+    cell_start.assign( cols * rows + 1, 0 );
+    for ( size_t i = 0; i < n; ++i ) { ++cell_start[ cellOf( xs[ i ], ys[ i ] ) + 1 ]; }
+    for ( size_t c = 0; c < cols * rows; ++c ) { cell_start[ c + 1 ] += cell_start[ c ]; }
+
+    order.resize( n );
+    std::vector<uint32_t> cursor( cell_start.begin(), cell_start.end() - 1 );
+    for ( size_t i = 0; i < n; ++i ) { order[ cursor[ cellOf( xs[ i ], ys[ i ] ) ]++ ] = static_cast<uint32_t>( i ); }
+  }
+
+  // 访问视口内的每棵树，fn( size_t index )，index 为树在森林中的下标
+  template <typename Fn>
+  void query( const Viewport &view, Fn &&fn ) const
+  {
+    if ( cols == 0 || view.max_x < view.min_x || view.max_y < view.min_y ) { return; }
+    const auto &xs = forest.xColumn();
+    const auto &ys = forest.yColumn();
+
+    const long long c0 = std::max( floorCell( view.min_x, origin_x ), 0LL );
+    const long long c1 = std::min( floorCell( view.max_x, origin_x ), static_cast<long long>( cols ) - 1 );
+    const long long r0 = std::max( floorCell( view.min_y, origin_y ), 0LL );
+    const long long r1 = std::min( floorCell( view.max_y, origin_y ), static_cast<long long>( rows ) - 1 );
+    if ( c0 > c1 || r0 > r1 ) { return; }
+
+    for ( long long r = r0; r <= r1; ++r ) {
+      for ( long long c = c0; c <= c1; ++c ) {
+        const size_t cell  = static_cast<size_t>( r ) * cols + static_cast<size_t>( c );
+        const long long x0 = origin_x + c * cell_size;
+        const long long y0 = origin_y + r * cell_size;
+        const bool inside  = x0 >= view.min_x && x0 + cell_size - 1 <= view.max_x && y0 >= view.min_y &&
+                            y0 + cell_size - 1 <= view.max_y;
+        for ( uint32_t k = cell_start[ cell ]; k < cell_start[ cell + 1 ]; ++k ) {
+          const uint32_t i = order[ k ];
+          if ( inside || ( xs[ i ] >= view.min_x && xs[ i ] <= view.max_x && ys[ i ] >= view.min_y &&
+                           ys[ i ] <= view.max_y ) ) {
+            fn( static_cast<size_t>( i ) );
+          }
+        }
+      }
+    }
+  }
+
+  // 把视口内的树按享元类型分组，每种类型调用一次 fn( const Tree &, const std::vector<std::pair<int, int>> & )
+  template <typename Fn>
+  void forEachBatch( const Viewport &view, Fn &&fn ) const
+  {
+    const auto &xs    = forest.xColumn();
+    const auto &ys    = forest.yColumn();
+    const auto &types = forest.typeColumn();
+    std::vector<std::vector<std::pair<int, int>>> batches( forest.getFactory().getTreeTypesCount() );
+    query( view, [ & ]( size_t i ) { batches[ types[ i ] ].emplace_back( xs[ i ], ys[ i ] ); } );
+    for ( size_t t = 0; t < batches.size(); ++t ) {
+      if ( !batches[ t ].empty() ) { fn( forest.getFactory().getTree( static_cast<TreeHandle>( t ) ), batches[ t ] ); }
+    }
+  }
+
+  // 只渲染视口内的树，每种树一个批次
+  void render( const Viewport &view ) const
+  {
+    Singleton::log_info( "\n渲染视口 [", view.min_x, ",", view.min_y, "] - [", view.max_x, ",", view.max_y,
+                         "] 内的树木:" );
+    forEachBatch( view, []( const Tree &tree, const std::vector<std::pair<int, int>> &positions ) {
+      tree.renderBatch( positions );
+    } );
+  }
+
+ private:
+  // 与 rebuild 一样先扩展到 long long：坐标跨度可能超过 int 的范围
+  size_t cellOf( int x, int y ) const
+  {
+    const auto col = static_cast<size_t>( ( static_cast<long long>( x ) - origin_x ) / cell_size );
+    const auto row = static_cast<size_t>( ( static_cast<long long>( y ) - origin_y ) / cell_size );
+    return row * cols + col;
+  }
+
+  // 坐标所在格子的下标（向下取整，视口超出网格时可以为负）
+  long long floorCell( int v, int origin ) const
+  {
+    const long long d = static_cast<long long>( v ) - origin;
+    return d >= 0 ? d / cell_size : -( ( -d + cell_size - 1 ) / cell_size );
+  }
+
+  const CompactForest &forest;
+  int requested_cell;
+  int cell_size;
+  int origin_x = 0;
+  int origin_y = 0;
+  size_t cols  = 0;
+  size_t rows  = 0;
+  std::vector<uint32_t> cell_start;  // 第 c 个格子中的树为 order[ cell_start[c], cell_start[c + 1] )
+  std::vector<uint32_t> order;
+};
+
+}  // namespace DesignPatterns::Flyweight
+
+#endif  // INCLUDE_STRUCTURAL_FLYWEIGHT_FOREST_GRID_H
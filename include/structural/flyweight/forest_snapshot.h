@@ -0,0 +1,281 @@
+#ifndef INCLUDE_STRUCTURAL_FLYWEIGHT_FOREST_SNAPSHOT_H
+#define INCLUDE_STRUCTURAL_FLYWEIGHT_FOREST_SNAPSHOT_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "structural/flyweight/compact_forest.h"
+
+namespace DesignPatterns::Flyweight
+{
+
+// 森林的二进制快照
+// 文件布局（本机字节序）：
+//   头部 64 字节 | 享元表：每种树 [u32 类型长度][u32 颜色长度][类型][颜色] | x 列 | y 列 | 句柄列
+// 三个列各自按 64 字节对齐，句柄是享元表中的下标。打开快照时只 mmap 文件并检查头部，
+// 实例数组不做任何解析和复制；享元表只有几种树，打开时在工厂中驻留一次，得到 下标 → Tree 的查找表。
+// 句柄列在打开时不逐个校验，而是在 tree / forEach / toCompactForest 使用时检查范围，损坏的快照抛出异常而不会越界
+
+namespace detail
+{
+
+constexpr uint32_t kSnapshotMagic   = 0x54535246;  // "FRST"
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr size_t kSnapshotAlign     = 64;
+
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t type_count;
+  uint64_t tree_count;
+  uint64_t types_offset;  // 享元表
+  uint64_t xs_offset;
+  uint64_t ys_offset;
+  uint64_t handles_offset;
+  uint64_t file_size;
+};
+static_assert( sizeof( SnapshotHeader ) <= kSnapshotAlign );
+
+inline uint64_t alignSnapshot( uint64_t offset )
+{
+  return ( offset + kSnapshotAlign - 1 ) / kSnapshotAlign * kSnapshotAlign;
+}
+
+// 把享元表和三个列写入文件，类型 i 的名称由 name( i ) 给出
+template <typename Name>
+void writeSnapshot( const std::filesystem::path &path, size_t type_count, Name &&name, std::span<const int> xs,
+                    std::span<const int> ys, std::span<const TreeHandle> handles )
+{
+  std::string table;
+  for ( size_t i = 0; i < type_count; ++i ) {
+    const auto [ type, color ] = name( i );
+    const uint32_t lens[ 2 ]   = { static_cast<uint32_t>( type.size() ), static_cast<uint32_t>( color.size() ) };
+    table.append( reinterpret_cast<const char *>( lens ), sizeof( lens ) );
+    table.append( type );
+    table.append( color );
+  }
+
+  SnapshotHeader header{};
+  header.magic          = kSnapshotMagic;
+  header.version        = kSnapshotVersion;
+  header.type_count     = type_count;
+  header.tree_count     = xs.size();
+  header.types_offset   = kSnapshotAlign;
+  header.xs_offset      = alignSnapshot( header.types_offset + table.size() );
+  header.ys_offset      = alignSnapshot( header.xs_offset + xs.size_bytes() );
+  header.handles_offset = alignSnapshot( header.ys_offset + ys.size_bytes() );
+  header.file_size      = header.handles_offset + handles.size_bytes();
+
+  std::ofstream out( path, std::ios::binary | std::ios::trunc );
+  if ( !out ) { throw std::runtime_error( "ForestSnapshot: cannot open " + path.string() ); }
+  auto pad_to = [ &out ]( uint64_t offset ) {
+    static const char zeros[ kSnapshotAlign ] = {};
+    out.write( zeros, static_cast<std::streamsize>( offset - static_cast<uint64_t>( out.tellp() ) ) );
+  };
+  out.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+  pad_to( header.types_offset );
+  out.write( table.data(), static_cast<std::streamsize>( table.size() ) );
+  pad_to( header.xs_offset );
+  out.write( reinterpret_cast<const char *>( xs.data() ), static_cast<std::streamsize>( xs.size_bytes() ) );
+  pad_to( header.ys_offset );
+  out.write( reinterpret_cast<const char *>( ys.data() ), static_cast<std::streamsize>( ys.size_bytes() ) );
+  pad_to( header.handles_offset );
+  out.write( reinterpret_cast<const char *>( handles.data() ), static_cast<std::streamsize>( handles.size_bytes() ) );
+  if ( !out.flush() ) { throw std::runtime_error( "ForestSnapshot: write failed for " + path.string() ); }
+}
+
+}  // namespace detail
+
+// 以只读方式映射的森林快照
+class ForestSnapshot
+{
+ public:
+  // 把 CompactForest 写成快照，句柄直接使用工厂中的编号
+  static void save( const CompactForest &forest, const std::filesystem::path &path )
+  {
+    const TreeFactory &factory = forest.getFactory();
+    detail::writeSnapshot(
+        path, factory.getTreeTypesCount(),
+        [ &factory ]( size_t i ) {
+          const Tree &tree = factory.getTree( static_cast<TreeHandle>( i ) );
+          return std::pair<std::string_view, std::string_view>( tree.getType(), tree.getColor() );
+        },
+        forest.xColumn(), forest.yColumn(), forest.typeColumn() );
+  }
+
+  // 映射快照，享元表中的每种树在 factory 中驻留
+  static ForestSnapshot open( const std::filesystem::path &path, std::shared_ptr<TreeFactory> factory )
+  {
+    int fd = ::open( path.c_str(), O_RDONLY );
+    if ( fd < 0 ) { throw std::runtime_error( "ForestSnapshot: cannot open " + path.string() ); }
+    struct stat st{};
+    if ( ::fstat( fd, &st ) != 0 ) {
+      ::close( fd );
+      throw std::runtime_error( "ForestSnapshot: cannot stat " + path.string() );
+    }
+    const size_t size = static_cast<size_t>( st.st_size );
+    if ( size < sizeof( detail::SnapshotHeader ) ) {
+      ::close( fd );
+      throw std::runtime_error( "ForestSnapshot: truncated file " + path.string() );
+    }
+    void *map = ::mmap( nullptr, size, PROT_READ, MAP_SHARED, fd, 0 );
+    ::close( fd );
+    if ( map == MAP_FAILED ) { throw std::runtime_error( "ForestSnapshot: mmap failed for " + path.string() ); }
+    return ForestSnapshot( static_cast<const unsigned char *>( map ), size, std::move( factory ), path );
+  }
+
+  ForestSnapshot( ForestSnapshot && ) noexcept = default;
+
+  ForestSnapshot( const ForestSnapshot & )            = delete;
+  ForestSnapshot &operator=( const ForestSnapshot & ) = delete;
+  ForestSnapshot &operator=( ForestSnapshot && )      = delete;
+
+  size_t size() const { return header_.tree_count; }
+  size_t typeCount() const { return header_.type_count; }
+
+  // 直接指向映射内存的列
+  std::span<const int> xColumn() const { return column<int>( header_.xs_offset ); }
+  std::span<const int> yColumn() const { return column<int>( header_.ys_offset ); }
+  std::span<const TreeHandle> handleColumn() const { return column<TreeHandle>( header_.handles_offset ); }
+
+  // 快照中第 i 种树
+  const Tree &tree( TreeHandle i ) const { return *lut_[ checked( i ) ]; }
+
+  // 依次访问每棵树，fn( const Tree &, int x, int y )；遇到超出享元表的句柄抛出 std::runtime_error
+  template <typename Fn>
+  void forEach( Fn &&fn ) const
+  {
+    const auto xs = xColumn(), ys = yColumn();
+    const auto handles = handleColumn();
+    for ( size_t i = 0; i < xs.size(); ++i ) { fn( *lut_[ checked( handles[ i ] ) ], xs[ i ], ys[ i ] ); }
+  }
+
+  void render() const
+  {
+    Singleton::log_info( "\n渲染快照中的所有树木 (", size(), " 棵树, ", typeCount(), " 种类型):" );
+    forEach( []( const Tree &tree, int x, int y ) { tree.render( x, y ); } );
+  }
+
+  // 把快照另存为新文件，实例数组直接从映射内存写出；path 不能是当前映射的文件
+  void save( const std::filesystem::path &path ) const
+  {
+    detail::writeSnapshot(
+        path, typeCount(), [ this ]( size_t i ) { return names_[ i ]; }, xColumn(), yColumn(), handleColumn() );
+  }
+
+  // 复制到可修改的 CompactForest，句柄换成工厂中的编号
+  CompactForest toCompactForest() const
+  {
+    CompactForest forest( factory_ );
+    forest.reserve( size() );
+    std::vector<TreeHandle> remap( typeCount() );
+    for ( size_t i = 0; i < remap.size(); ++i ) {
+      remap[ i ] = factory_->getHandle( names_[ i ].first, names_[ i ].second );
+    }
+    const auto xs = xColumn(), ys = yColumn();
+    const auto handles = handleColumn();
+    for ( size_t i = 0; i < xs.size(); ++i ) { forest.plantTree( xs[ i ], ys[ i ], remap[ checked( handles[ i ] ) ] ); }
+    return forest;
+  }
+
+ private:
+  // 只读映射，析构时解除；作为第一个成员构造，构造函数中途抛出异常时也会被释放
+  class Mapping
+  {
+   public:
+    Mapping( const unsigned char *base, size_t size ) : base_( base ), size_( size ) {}
+    Mapping( Mapping &&other ) noexcept
+        : base_( std::exchange( other.base_, nullptr ) ), size_( std::exchange( other.size_, 0 ) )
+    {
+    }
+    Mapping( const Mapping & )            = delete;
+    Mapping &operator=( const Mapping & ) = delete;
+    Mapping &operator=( Mapping && )      = delete;
+    ~Mapping()
+    {
+      if ( base_ ) { ::munmap( const_cast<unsigned char *>( base_ ), size_ ); }
+    }
+
+    const unsigned char *data() const { return base_; }
+    size_t size() const { return size_; }
+
+   private:
+    const unsigned char *base_;
+    size_t size_;
+  };
+
+  ForestSnapshot( const unsigned char *base, size_t size, std::shared_ptr<TreeFactory> factory,
+                  const std::filesystem::path &path )
+      : map_( base, size ), factory_( std::move( factory ) )
+  {
+    auto fail = [ & ]( const char *what ) {
+      throw std::runtime_error( std::string( "ForestSnapshot: " ) + what + " in " + path.string() );
+    };
+    std::memcpy( &header_, base, sizeof( header_ ) );
+    if ( header_.magic != detail::kSnapshotMagic ) { fail( "bad magic" ); }
+    if ( header_.version != detail::kSnapshotVersion ) { fail( "unsupported version" ); }
+    // 先限制各个偏移和数量都不超过文件大小，后面的加法和乘法就不会溢出
+    const uint64_t n = header_.tree_count;
+    if ( header_.file_size != size || header_.types_offset < sizeof( header_ ) ||
+         header_.types_offset > header_.xs_offset || header_.xs_offset > size || header_.ys_offset > size ||
+         header_.handles_offset > size || n > size / sizeof( int ) ) {
+      fail( "corrupt layout" );
+    }
+    if ( header_.xs_offset % detail::kSnapshotAlign != 0 || header_.ys_offset % detail::kSnapshotAlign != 0 ||
+         header_.handles_offset % detail::kSnapshotAlign != 0 ||
+         header_.xs_offset + n * sizeof( int ) > header_.ys_offset ||
+         header_.ys_offset + n * sizeof( int ) > header_.handles_offset ||
+         header_.handles_offset + n * sizeof( TreeHandle ) > size ) {
+      fail( "corrupt layout" );
+    }
+
+    uint64_t offset = header_.types_offset;
+    for ( uint64_t i = 0; i < header_.type_count; ++i ) {
+      uint32_t lens[ 2 ];
+      if ( offset + sizeof( lens ) > header_.xs_offset ) { fail( "corrupt type table" ); }
+      std::memcpy( lens, base + offset, sizeof( lens ) );
+      offset += sizeof( lens );
+      if ( offset + lens[ 0 ] + lens[ 1 ] > header_.xs_offset ) { fail( "corrupt type table" ); }
+      const char *chars = reinterpret_cast<const char *>( base + offset );
+      names_.emplace_back( std::string_view( chars, lens[ 0 ] ), std::string_view( chars + lens[ 0 ], lens[ 1 ] ) );
+      offset += lens[ 0 ] + lens[ 1 ];
+    }
+    for ( const auto &[ type, color ] : names_ ) { lut_.push_back( factory_->getTree( type, color ).get() ); }
+  }
+
+  size_t checked( TreeHandle handle ) const
+  {
+    if ( handle >= lut_.size() ) { throw std::runtime_error( "ForestSnapshot: handle out of range" ); }
+    return handle;
+  }
+
+  template <typename T>
+  std::span<const T> column( uint64_t offset ) const
+  {
+    return { reinterpret_cast<const T *>( map_.data() + offset ), static_cast<size_t>( header_.tree_count ) };
+  }
+
+  Mapping map_;
+  detail::SnapshotHeader header_{};
+  std::shared_ptr<TreeFactory> factory_;
+  std::vector<std::pair<std::string_view, std::string_view>> names_;  // 指向映射内存
+  std::vector<const Tree *> lut_;                                     // 快照中的下标 → 工厂中的树
+};
+
+}  // namespace DesignPatterns::Flyweight
+
+#endif  // INCLUDE_STRUCTURAL_FLYWEIGHT_FOREST_SNAPSHOT_H
@@ -0,0 +1,154 @@
+#ifndef INCLUDE_STRUCTURAL_FLYWEIGHT_INTERN_POOL_H
+#define INCLUDE_STRUCTURAL_FLYWEIGHT_INTERN_POOL_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DesignPatterns::Flyweight
+{
+
+// 享元对象的驻留池，以两个字符串（如树的类型和颜色）为键
+// - 查找直接使用 string_view 计算哈希和比较，不拼接临时字符串
+// - 开放寻址哈希表，槽位中保存指向条目的原子指针，查找完全无锁
+// - 插入很少发生，由互斥锁串行化；扩容时发布一张新表，旧表保留到池销毁，正在读旧表的线程不受影响
+// - 每个条目有一个从 0 开始的 32 位编号，可以通过 at() 无锁地按编号取回
+template <typename T>
+class InternPool
+{
+ public:
+  struct Entry {
+    size_t hash;
+    uint32_t id;  // 按插入顺序分配的编号
+    std::string first;
+    std::string second;
+    std::shared_ptr<T> value;
+  };
+
+  explicit InternPool( size_t initial_capacity = 64 )
+  {
+    size_t cap = 16;
+    while ( cap < initial_capacity ) { cap <<= 1; }
+    tables_.push_back( std::make_unique<Table>( cap ) );
+    table_.store( tables_.back().get(), std::memory_order_release );
+  }
+
+  InternPool( const InternPool & )            = delete;
+  InternPool &operator=( const InternPool & ) = delete;
+
+  static size_t hashKey( std::string_view first, std::string_view second )
+  {
+    const size_t h1 = std::hash<std::string_view>{}( first );
+    const size_t h2 = std::hash<std::string_view>{}( second );
+    return h1 ^ ( h2 + 0x9e3779b97f4a7c15ull + ( h1 << 6 ) + ( h1 >> 2 ) );
+  }
+
+  // 无锁查找，不存在时返回 nullptr
+  const Entry *find( std::string_view first, std::string_view second ) const
+  {
+    return findIn( *table_.load( std::memory_order_acquire ), hashKey( first, second ), first, second );
+  }
+
+  // 查找或创建，make() 只会在条目不存在时于锁内调用一次
+  template <typename Make>
+  const Entry &intern( std::string_view first, std::string_view second, Make &&make )
+  {
+    const size_t hash = hashKey( first, second );
+    if ( const Entry *e = findIn( *table_.load( std::memory_order_acquire ), hash, first, second ) ) { return *e; }
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+    Table *table = table_.load( std::memory_order_relaxed );
+    if ( const Entry *e = findIn( *table, hash, first, second ) ) { return *e; }
+
+    if ( ( entries_.size() + 1 ) * 2 > table->mask + 1 ) { table = grow( *table ); }
+
+    auto entry = std::make_unique<Entry>(
+        Entry{ hash, static_cast<uint32_t>( entries_.size() ), std::string( first ), std::string( second ), make() } );
+    insertInto( *table, entry.get() );
+    publishId( entry.get() );
+    entries_.push_back( std::move( entry ) );
+    size_.store( entries_.size(), std::memory_order_release );
+    return *entries_.back();
+  }
+
+  size_t size() const { return size_.load( std::memory_order_acquire ); }
+
+  // 按编号无锁取回条目，id 必须小于 size()
+  const Entry &at( uint32_t id ) const
+  {
+    const size_t chunk  = std::bit_width( id / kFirstChunk + 1 ) - 1;
+    const size_t offset = id - kFirstChunk * ( ( size_t( 1 ) << chunk ) - 1 );
+    return *byId_[ chunk ].load( std::memory_order_acquire )[ offset ].load( std::memory_order_acquire );
+  }
+
+ private:
+  // 编号索引按块存放，第 c 块容纳 kFirstChunk << c 个条目，块一旦分配就不再移动
+  static constexpr size_t kFirstChunk = 64;
+  static constexpr size_t kMaxChunks  = 27;  // 足以覆盖全部 32 位编号
+
+  struct Table {
+    explicit Table( size_t capacity )
+        : mask( capacity - 1 ), slots( std::make_unique<std::atomic<Entry *>[]>( capacity ) )
+    {
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<Entry *>[]> slots;
+  };
+
+  static const Entry *findIn( const Table &table, size_t hash, std::string_view first, std::string_view second )
+  {
+    for ( size_t i = hash & table.mask;; i = ( i + 1 ) & table.mask ) {
+      const Entry *e = table.slots[ i ].load( std::memory_order_acquire );
+      if ( !e ) { return nullptr; }
+      if ( e->hash == hash && e->first == first && e->second == second ) { return e; }
+    }
+  }
+
+  static void insertInto( Table &table, Entry *entry )
+  {
+    size_t i = entry->hash & table.mask;
+    while ( table.slots[ i ].load( std::memory_order_relaxed ) ) { i = ( i + 1 ) & table.mask; }
+    table.slots[ i ].store( entry, std::memory_order_release );
+  }
+
+  Table *grow( const Table &old )
+  {
+    auto table = std::make_unique<Table>( ( old.mask + 1 ) * 2 );
+    for ( const auto &entry : entries_ ) { insertInto( *table, entry.get() ); }
+    tables_.push_back( std::move( table ) );
+    table_.store( tables_.back().get(), std::memory_order_release );
+    return tables_.back().get();
+  }
+
+  void publishId( const Entry *entry )
+  {
+    const size_t chunk  = std::bit_width( entry->id / kFirstChunk + 1 ) - 1;
+    const size_t offset = entry->id - kFirstChunk * ( ( size_t( 1 ) << chunk ) - 1 );
+    if ( !idChunks_[ chunk ] ) {
+      idChunks_[ chunk ] = std::make_unique<std::atomic<const Entry *>[]>( kFirstChunk << chunk );
+      byId_[ chunk ].store( idChunks_[ chunk ].get(), std::memory_order_release );
+    }
+    idChunks_[ chunk ][ offset ].store( entry, std::memory_order_release );
+  }
+
+  std::atomic<Table *> table_{ nullptr };
+  std::atomic<size_t> size_{ 0 };
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Table>> tables_;  // 包括已经退役的旧表
+  std::vector<std::unique_ptr<Entry>> entries_;
+  std::array<std::unique_ptr<std::atomic<const Entry *>[]>, kMaxChunks> idChunks_;
+  std::array<std::atomic<std::atomic<const Entry *> *>, kMaxChunks> byId_{};
+};
+
+}  // namespace DesignPatterns::Flyweight
+
+#endif  // INCLUDE_STRUCTURAL_FLYWEIGHT_INTERN_POOL_H
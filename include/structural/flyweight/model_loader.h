@@ -0,0 +1,87 @@
+#ifndef INCLUDE_STRUCTURAL_FLYWEIGHT_MODEL_LOADER_H
+#define INCLUDE_STRUCTURAL_FLYWEIGHT_MODEL_LOADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace DesignPatterns::Flyweight
+{
+
+// 后台加载线程池
+// submit() 只是把任务放入队列并返回 shared_future，所有持有者共享同一次加载的结果；
+// 析构时先执行完队列中剩余的任务再退出，已经发出的 future 不会失效
+class ModelLoader
+{
+ public:
+  explicit ModelLoader( size_t threads = 2 )
+  {
+    if ( threads == 0 ) { threads = 1; }
+    for ( size_t i = 0; i < threads; ++i ) {
+      workers_.emplace_back( [ this ]( std::stop_token token ) { run( token ); } );
+    }
+  }
+
+  ModelLoader( const ModelLoader & )            = delete;
+  ModelLoader &operator=( const ModelLoader & ) = delete;
+
+  ~ModelLoader()
+  {
+    for ( auto &w : workers_ ) { w.request_stop(); }
+    ready_.notify_all();
+  }  // jthread 析构时自动 join
+
+  template <typename Fn>
+  std::shared_future<std::invoke_result_t<Fn>> submit( Fn &&fn )
+  {
+    using Result = std::invoke_result_t<Fn>;
+    auto task    = std::make_shared<std::packaged_task<Result()>>( std::forward<Fn>( fn ) );
+    std::shared_future<Result> future = task->get_future().share();
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      tasks_.emplace_back( [ task ]() { ( *task )(); } );
+    }
+    ready_.notify_one();
+    return future;
+  }
+
+  // 还在排队、尚未开始执行的任务数
+  size_t pending() const
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return tasks_.size();
+  }
+
+ private:
+  void run( std::stop_token token )
+  {
+    for ( ;; ) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        ready_.wait( lock, token, [ this ]() { return !tasks_.empty(); } );
+        if ( tasks_.empty() ) { return; }  // 已请求停止且队列已清空
+        task = std::move( tasks_.front() );
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable_any ready_;
+  std::deque<std::function<void()>> tasks_;
+  std::vector<std::jthread> workers_;  // 最后声明，先于队列析构
+};
+
+}  // namespace DesignPatterns::Flyweight
+
+#endif  // INCLUDE_STRUCTURAL_FLYWEIGHT_MODEL_LOADER_H
@@ -1,11 +1,12 @@
 #ifndef INCLUDE_STRUCTURAL_PROXY_PROXY_H
 #define INCLUDE_STRUCTURAL_PROXY_PROXY_H
 
-#include <iostream>
 #include <string>
 #include <memory>
 #include <functional>
 
+#include "creational/singleton/logger.h"
+
 namespace DesignPatterns::Proxy
 {
 
@@ -66,14 +67,17 @@ class TemperatureMonitor
             &currentTemp,
             // 设置温度时的回调
             [ this ]( const double &newTemp ) {
-              std::cout << "温度变化通知: " << currentTemp << "°C → " << newTemp << "°C" << std::endl;
-              if ( newTemp > 80.0 ) { std::cout << "警告: 温度过高!" << std::endl; }
+              Singleton::log_info( "温度变化通知: ", currentTemp, "°C → ", newTemp, "°C" );
+              if ( newTemp > 80.0 ) { Singleton::log_warn( "警告: 温度过高!" ); }
             },
-            [ this ]() { std::cout << "读取当前温度: "; } )
+            []() { Singleton::log_info( "读取当前温度" ); } )
   {
   }
 
-  void displayStatus() const { std::cout << "当前系统状态: 温度 " << temperature << "°C" << std::endl; }
+  void displayStatus() const
+  {
+    Singleton::log_info( "当前系统状态: 温度 ", static_cast<double>( temperature ), "°C" );
+  }
 };
 
 }  // namespace DesignPatterns::Proxy
@@ -1,6 +1,54 @@
 #include "behavioral/command/command.h"
+#include "behavioral/command/command_queue.h"
+#include "behavioral/command/command_value.h"
+#include "behavioral/command/command_journal.h"
+#include "behavioral/command/command_wal.h"
+#include "behavioral/command/account_store.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
 
 using namespace DesignPatterns::Command;
+
+namespace
+{
+
+// 统计命令对象的堆分配次数，仅用于基准测试中比较两种命令存储方式。
+// 只给基准用到的命令类型加类内的 operator new，不影响测试程序里的其他分配
+std::atomic<size_t> g_allocations{ 0 };
+
+template <typename Base>
+struct Counted : Base {
+  using Base::Base;
+
+  static void *operator new( std::size_t size )
+  {
+    g_allocations.fetch_add( 1, std::memory_order_relaxed );
+    return ::operator new( size );
+  }
+  static void operator delete( void *p ) noexcept { ::operator delete( p ); }
+};
+
+// 超过 CommandValue 内部缓冲区的命令：带一段备注，不继承 Command
+struct MemoDeposit {
+  BankAccount &account;
+  int amount;
+  char memo[ 64 ] = "transfer from savings";
+
+  MemoDeposit( BankAccount &acc, int amt ) : account( acc ), amount( amt ) {}
+  void execute() { account.deposit( amount ); }
+  void undo() { account.withdraw( amount ); }
+};
+
+using CountedDeposit  = Counted<DepositCommand>;
+using CountedWithdraw = Counted<WithdrawCommand>;
+using CountedMemo     = Counted<MemoDeposit>;
+
+}  // namespace
 int test_command()
 {
   BankAccount account;
@@ -16,5 +64,354 @@ int test_command()
   cmd1->undo();
 
   std::cout << "Balance after undo: " << account.getBalance() << "\n";
+
+  // 多个线程提交命令，由执行线程统一执行
+  BankAccount shared;
+  CommandExecutor executor( 1024, 64 );
+  executor.start();
+  std::vector<std::thread> producers;
+  for ( int t = 0; t < 4; ++t ) {
+    producers.emplace_back( [ &shared, &executor ]() {
+      for ( int i = 0; i < 1000; ++i ) { executor.submit( std::make_unique<DepositCommand>( shared, 1 ) ); }
+    } );
+  }
+  // 运行期间也可以读取统计，执行数只增不减
+  size_t seen = 0;
+  for ( int i = 0; i < 100; ++i ) {
+    const size_t executed = executor.stats().executed;
+    if ( executed < seen ) { return 1; }
+    seen = executed;
+  }
+  for ( auto &p : producers ) { p.join(); }
+  executor.stop();
+
+  ExecutorStats stats = executor.stats();
+  std::cout << "Executor balance: " << shared.getBalance() << ", executed " << stats.executed << " commands in "
+            << stats.batches << " batches\n";
+  if ( shared.getBalance() != 4000 || stats.executed != 4000 || stats.p50_ns > stats.max_ns ) { return 1; }
+
+  // 要求的容量小于 2 时取 2：满了就拒绝，不会覆盖还没取走的元素
+  for ( size_t requested : { size_t( 0 ), size_t( 1 ) } ) {
+    MpscRing<int> tiny( requested );
+    int one = 1, two = 2, three = 3, out = 0;
+    if ( tiny.capacity() != 2 || !tiny.try_push( one ) || !tiny.try_push( two ) || tiny.try_push( three ) ) {
+      return 1;
+    }
+    if ( !tiny.try_pop( out ) || out != 1 || !tiny.try_pop( out ) || out != 2 || tiny.try_pop( out ) ) { return 1; }
+  }
+
+  // 值语义命令与扁平的撤销 / 重做历史
+  BankAccount flat;
+  CommandHistory history;
+  history.execute( DepositCommand( flat, 100 ) );
+  history.execute( WithdrawCommand( flat, 30 ) );
+  history.execute( WithdrawCommand( flat, 1000 ) );  // 超出透支额度，不会成功
+  std::cout << "History balance: " << flat.getBalance() << "\n";
+  history.undo();
+  history.undo();
+  std::cout << "After two undos: " << flat.getBalance() << "\n";
+  history.redo();
+  std::cout << "After redo: " << flat.getBalance() << "\n";
+  if ( flat.getBalance() != 70 || history.redoCount() != 1 ) { return 1; }
+
+  // 放不进内部缓冲区的命令退回到堆上，vector 扩容时只移动指针
+  static_assert( !CommandValue::kStoredInline<MemoDeposit> && CommandValue::kStoredInline<DepositCommand> );
+  BankAccount memo_account;
+  CommandHistory memos;
+  for ( int i = 0; i < 100; ++i ) {
+    if ( i % 2 ) {
+      memos.execute( MemoDeposit( memo_account, 3 ) );
+    } else {
+      memos.execute( DepositCommand( memo_account, 1 ) );
+    }
+  }
+  CommandValue large( MemoDeposit( memo_account, 0 ) ), small( DepositCommand( memo_account, 0 ) );
+  CommandValue moved_large = std::move( large );
+  const int memo_total     = memo_account.getBalance();
+  while ( memos.undo() ) {}
+  std::cout << "Oversized commands: balance " << memo_total << ", after undo " << memo_account.getBalance() << "\n";
+  if ( memo_total != 200 || memo_account.getBalance() != 0 || !moved_large.onHeap() || large || small.onHeap() ) {
+    return 1;
+  }
+
+  // 内存有上限的增量日志：超过上限后最旧的记录被丢弃，快照可以直接跳回
+  BankAccount a, b;
+  CommandJournal journal( 64 * 1024, 1000 );
+  uint32_t ia = journal.addAccount( a );
+  uint32_t ib = journal.addAccount( b );
+  for ( int i = 0; i < 100000; ++i ) {
+    journal.deposit( ia, 2 );
+    journal.withdraw( ib, 1 );
+  }
+  std::cout << "Journal balances: " << a.getBalance() << ", " << b.getBalance() << ", undo depth "
+            << journal.undoCount() << ", memory " << journal.memoryUsage() << " bytes\n";
+  if ( journal.memoryUsage() > 64 * 1024 ) { return 1; }
+
+  while ( journal.undo() ) {}
+  std::cout << "Oldest undoable state: " << a.getBalance() << ", " << b.getBalance() << "\n";
+  while ( journal.redo() ) {}
+  if ( a.getBalance() != 200000 || b.getBalance() != -500 ) { return 1; }
+
+  // 账户很多时快照比记录块大得多，同样受内存上限约束；单个快照放不下时不再保存快照
+  for ( size_t account_count : { size_t( 5000 ), size_t( 100000 ) } ) {
+    std::vector<BankAccount> many( account_count );
+    CommandJournal wide( 128 * 1024, 100 );
+    for ( auto &acc : many ) { wide.addAccount( acc ); }
+    size_t peak = 0;
+    for ( int i = 0; i < 20000; ++i ) {
+      wide.deposit( static_cast<uint32_t>( i % account_count ), 1 );
+      peak = std::max( peak, wide.memoryUsage() );
+    }
+    std::cout << account_count << " accounts: peak journal memory " << peak << " bytes, " << wide.snapshotCount()
+              << " snapshots, undo depth " << wide.undoCount() << "\n";
+    if ( peak > 128 * 1024 || wide.undoCount() == 0 || ( account_count == 5000 ) != ( wide.snapshotCount() > 0 ) ) {
+      return 1;
+    }
+  }
+
+  journal.restoreSnapshot( 0 );
+  std::cout << "Oldest snapshot: " << a.getBalance() << ", " << b.getBalance() << ", redo depth "
+            << journal.redoCount() << "\n";
+  while ( journal.redo() ) {}
+  if ( a.getBalance() != 200000 || b.getBalance() != -500 ) { return 1; }
+
+  // 快照之后才注册的账户：跳回快照时恢复到注册时的余额，撤销、重做与日志位置保持一致
+  {
+    BankAccount first, later;
+    later.balance = 300;
+    CommandJournal late( 64 * 1024, 4 );
+    const uint32_t i_first = late.addAccount( first );
+    late.deposit( i_first, 1 );  // 位置 0 的快照只有 first
+    const uint32_t i_later = late.addAccount( later );
+    for ( int i = 0; i < 6; ++i ) { late.deposit( i_later, 10 ); }  // 位置 4 的快照包含两个账户
+    late.restoreSnapshot( 0 );
+    const int at_oldest = later.getBalance();
+    late.redo();
+    late.redo();
+    const int after_redo = later.getBalance();
+    late.restoreSnapshot( 1 );
+    const int at_newer = later.getBalance();
+    while ( late.redo() ) {}
+    std::cout << "Account added after a snapshot: " << at_oldest << " -> " << after_redo << " -> " << at_newer
+              << " -> " << later.getBalance() << "\n";
+    if ( at_oldest != 300 || after_redo != 310 || at_newer != 330 || later.getBalance() != 360 ||
+         first.getBalance() != 1 ) {
+      return 1;
+    }
+  }
+
+  // 预写日志：重启后通过回放恢复账户状态
+  const auto wal_dir = std::filesystem::temp_directory_path() / "design_patterns_wal_test";
+  std::filesystem::remove_all( wal_dir );
+  std::vector<BankAccount> live( 2 );
+  {
+    WriteAheadLog::Options options;
+    options.segment_size = 4096;  // 很小的段，顺便验证换段
+    WriteAheadLog wal( wal_dir, options );
+    for ( int i = 0; i < 1000; ++i ) {
+      LoggedDepositCommand( wal, 0, live[ 0 ], 3 ).execute();
+      LoggedWithdrawCommand( wal, 1, live[ 1 ], 1 ).execute();
+      if ( i % 100 == 99 ) { wal.commit(); }
+    }
+  }
+  // 目录里名字不是段编号的 .wal 文件不影响打开和回放
+  std::ofstream( wal_dir / "backup.wal" ) << "not a segment";
+  std::ofstream( wal_dir / "000001.wal.bak" ) << "not a segment";
+  std::ofstream( wal_dir / "12abc.wal" ) << "not a segment";
+  std::vector<BankAccount> recovered;
+  size_t replayed = WriteAheadLog::replayInto( wal_dir, recovered );
+  std::cout << "Replayed " << replayed << " records: " << recovered[ 0 ].getBalance() << ", "
+            << recovered[ 1 ].getBalance() << "\n";
+  {
+    WriteAheadLog::Options options;
+    options.segment_size = 4096;
+    WriteAheadLog wal( wal_dir, options );  // 重启后从日志末尾继续追加
+    LoggedDepositCommand( wal, 0, live[ 0 ], 3 ).execute();
+  }
+  recovered.clear();
+  replayed = WriteAheadLog::replayInto( wal_dir, recovered );
+  std::filesystem::remove_all( wal_dir );
+  if ( replayed != 2001 ) { return 1; }
+  if ( recovered[ 0 ].getBalance() != live[ 0 ].getBalance() ||
+       recovered[ 1 ].getBalance() != live[ 1 ].getBalance() ) {
+    return 1;
+  }
+
+  // Interval 模式：提交之后即使不再有 commit()，后台线程也会在一个间隔内刷盘
+  {
+    WriteAheadLog::Options options;
+    options.durability = Durability::Interval;
+    options.interval   = std::chrono::milliseconds( 5 );
+    WriteAheadLog wal( wal_dir, options );
+    BankAccount account;
+    for ( int i = 0; i < 100; ++i ) { LoggedDepositCommand( wal, 0, account, 1 ).execute(); }
+    wal.commit();
+    for ( int i = 0; i < 200 && wal.unsyncedCommitted() > 0; ++i ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+    }
+    std::cout << "Interval WAL unsynced after idle: " << wal.unsyncedCommitted() << " bytes\n";
+    if ( wal.unsyncedCommitted() != 0 ) { return 1; }
+  }
+  std::filesystem::remove_all( wal_dir );
+
+  // 多个线程同时对同一个账户取款，透支额度在竞争下依然有效
+  AccountStore store( 1000 );
+  std::vector<std::thread> withdrawers;
+  for ( int t = 0; t < 8; ++t ) {
+    withdrawers.emplace_back( [ &store ]() {
+      for ( int i = 0; i < 1000; ++i ) { AtomicWithdrawCommand( store, 7, 1 ).execute(); }
+    } );
+  }
+  for ( auto &t : withdrawers ) { t.join(); }
+  std::cout << "Contended balance: " << store.balance( 7 ) << "\n";
+  if ( store.balance( 7 ) != store.overdraftLimit() ) { return 1; }
+  return 0;
+}
+
+// 多生产者提交命令的吞吐与延迟
+int bench_command()
+{
+  const int total = 1000000;
+  for ( int producers : { 1, 2, 4, 8 } ) {
+    BankAccount account;
+    CommandExecutor executor;
+    executor.start();
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < producers; ++t ) {
+      threads.emplace_back( [ &account, &executor, producers ]() {
+        for ( int i = 0; i < total / producers; ++i ) {
+          executor.submit( std::make_unique<DepositCommand>( account, 1 ) );
+        }
+      } );
+    }
+    for ( auto &t : threads ) { t.join(); }
+    executor.stop();
+
+    ExecutorStats stats = executor.stats();
+    std::cout << producers << " producers: " << stats.throughput / 1e6 << " M cmd/s, p50 " << stats.p50_ns
+              << " ns, p99 " << stats.p99_ns << " ns, p99.9 " << stats.p999_ns << " ns, avg batch "
+              << static_cast<double>( stats.executed ) / stats.batches << "\n";
+  }
+
+  // 每百万条命令的堆分配次数：unique_ptr<Command> 与 CommandValue
+  const size_t million = 1000000;
+  BankAccount account;
+
+  std::vector<std::unique_ptr<Command>> pointers;
+  pointers.reserve( million );
+  size_t before = g_allocations.load();
+  auto start    = std::chrono::steady_clock::now();
+  for ( size_t i = 0; i < million; ++i ) {
+    pointers.push_back( i % 2 ? std::unique_ptr<Command>( std::make_unique<CountedDeposit>( account, 2 ) )
+                              : std::unique_ptr<Command>( std::make_unique<CountedWithdraw>( account, 1 ) ) );
+    pointers.back()->execute();
+  }
+  for ( auto it = pointers.rbegin(); it != pointers.rend(); ++it ) { ( *it )->undo(); }
+  double pointer_ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+  size_t pointer_allocs = g_allocations.load() - before;
+
+  CommandHistory history;
+  history.reserve( million );
+  before = g_allocations.load();
+  start  = std::chrono::steady_clock::now();
+  for ( size_t i = 0; i < million; ++i ) {
+    if ( i % 2 ) {
+      history.execute( CountedDeposit( account, 2 ) );
+    } else {
+      history.execute( CountedWithdraw( account, 1 ) );
+    }
+  }
+  while ( history.undo() ) {}
+  double value_ms     = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+  size_t value_allocs = g_allocations.load() - before;
+
+  // 超过内部缓冲区的命令在 CommandValue 中退回到堆上，每条一次分配
+  history.clear();
+  before = g_allocations.load();
+  start  = std::chrono::steady_clock::now();
+  for ( size_t i = 0; i < million; ++i ) { history.execute( CountedMemo( account, 1 ) ); }
+  while ( history.undo() ) {}
+  double heap_ms     = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+  size_t heap_allocs = g_allocations.load() - before;
+
+  std::cout << "unique_ptr<Command>:            " << pointer_allocs << " allocations, " << pointer_ms << " ms\n";
+  std::cout << "CommandValue:                   " << value_allocs << " allocations, " << value_ms << " ms\n";
+  std::cout << "CommandValue (" << sizeof( MemoDeposit ) << "-byte command): " << heap_allocs << " allocations, "
+            << heap_ms << " ms\n";
+
+  // 各种持久化级别下每秒能写入多少条命令
+  const auto wal_dir = std::filesystem::temp_directory_path() / "design_patterns_wal_bench";
+  struct Level {
+    const char *name;
+    Durability durability;
+    int batch;
+  };
+  for ( const Level &level : { Level{ "none", Durability::None, 1 }, Level{ "per command", Durability::PerBatch, 1 },
+                               Level{ "per 64 batch", Durability::PerBatch, 64 },
+                               Level{ "per 10 ms", Durability::Interval, 1 } } ) {
+    std::filesystem::remove_all( wal_dir );
+    const int count = level.durability == Durability::PerBatch && level.batch == 1 ? 2000 : 200000;
+    WriteAheadLog::Options options;
+    options.durability = level.durability;
+    options.interval   = std::chrono::milliseconds( 10 );
+    BankAccount logged;
+    auto wal_start = std::chrono::steady_clock::now();
+    {
+      WriteAheadLog wal( wal_dir, options );
+      for ( int i = 0; i < count; ++i ) {
+        LoggedDepositCommand( wal, 0, logged, 1 ).execute();
+        if ( ( i + 1 ) % level.batch == 0 ) { wal.commit(); }
+      }
+    }
+    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - wal_start ).count();
+    std::cout << "WAL durability " << level.name << ": " << count / seconds << " cmd/s\n";
+  }
+  std::filesystem::remove_all( wal_dir );
+
+  // 并发账户存储：1 到 64 个线程在一百万个账户上随机存取款，以及每个线程只操作自己的一个账户（相邻编号，
+  // Packed 布局下这些账户挤在少数几个缓存行里），分别比较两种布局
+  for ( AccountLayout layout : { AccountLayout::Packed, AccountLayout::Padded } ) {
+    const char *layout_name = layout == AccountLayout::Packed ? "Packed" : "Padded";
+    AccountStore accounts( 1000000, 64, -500, layout );
+    AccountStore own( 64, 1, -500, layout );  // 一个分片，账户 t 紧挨着账户 t + 1
+    for ( int threads = 1; threads <= 64; threads *= 2 ) {
+      const size_t ops_per_thread = 4000000 / threads;
+      auto run                    = [ threads, ops_per_thread ]( auto &&op ) {
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for ( int t = 0; t < threads; ++t ) {
+          workers.emplace_back( [ &op, ops_per_thread, t ]() {
+            uint64_t x = 88172645463325252ull + t;
+            for ( size_t i = 0; i < ops_per_thread; ++i ) {
+              x ^= x << 13;
+              x ^= x >> 7;
+              x ^= x << 17;
+              op( t, x );
+            }
+          } );
+        }
+        for ( auto &w : workers ) { w.join(); }
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        return ops_per_thread * threads / seconds / 1e6;
+      };
+      const double random = run( [ &accounts ]( int, uint64_t x ) {
+        const size_t id = x % accounts.size();
+        if ( x & 1 ) {
+          accounts.deposit( id, 1 );
+        } else {
+          accounts.withdraw( id, 1 );
+        }
+      } );
+      const double owned = run( [ &own ]( int t, uint64_t x ) {
+        if ( x & 1 ) {
+          own.deposit( static_cast<size_t>( t ), 1 );
+        } else {
+          own.withdraw( static_cast<size_t>( t ), 1 );
+        }
+      } );
+      std::cout << "AccountStore " << layout_name << " " << threads << " threads: random " << random
+                << " M ops/s, own account " << owned << " M ops/s\n";
+    }
+  }
   return 0;
-}
\ No newline at end of file
+}
@@ -1,5 +1,12 @@
 #include "behavioral/responsibility_chain/responsibility_chain.h"
+#include "behavioral/responsibility_chain/parallel_check.h"
+#include "behavioral/responsibility_chain/incremental_check.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 int test_responsibility_chain()
 {
@@ -25,5 +32,197 @@ int test_responsibility_chain()
     std::cout << "验证失败" << std::endl;
   }
 
+  // SoA 路径的批量校验，结果应与链式校验一致
+  std::cout << "\n=== SoA 批量校验 ===" << std::endl;
+  DesignPatterns::ResponsibilityChain::JointPathSoA soa;
+  size_t bad_index = 0;
+  if ( !DesignPatterns::ResponsibilityChain::JointPathSoA::fromJointPath( path, soa, &bad_index ) ) {
+    std::cout << "转换失败，维度错误的下标: " << bad_index << std::endl;
+  }
+
+  path.points.back().joints.push_back( 2.0 );
+  DesignPatterns::ResponsibilityChain::JointPathSoA::fromJointPath( path, soa );
+  DesignPatterns::ResponsibilityChain::JointLimits limits;
+  limits.upper.fill( 1.5 );
+
+  DesignPatterns::ResponsibilityChain::JointLengthCheck len;
+  DesignPatterns::ResponsibilityChain::JointDimensionCheck dim;
+  DesignPatterns::ResponsibilityChain::JointVelocityCheck vel;
+  DesignPatterns::ResponsibilityChain::JointLimitCheck lim;
+  lim.limits = limits;
+  len.next   = &dim;
+  dim.next   = &vel;
+  vel.next   = &lim;
+
+  bool chain_ok = len.check( path );
+  bool soa_ok   = planner.validateJoint( soa, limits );
+  std::cout << "链式校验: " << ( chain_ok ? "通过" : "失败" ) << ", SoA 校验: " << ( soa_ok ? "通过" : "失败" )
+            << std::endl;
+  if ( chain_ok != soa_ok ) { return 1; }
+
+  if ( !planner.validateJoint( soa ) ) { return 1; }
+  std::cout << "去掉限位后 SoA 校验通过" << std::endl;
+
+  // 并行分块校验：多个块同时出错时，报告的仍然是最小的出错下标
+  std::cout << "\n=== 并行分块校验 ===" << std::endl;
+  DesignPatterns::ResponsibilityChain::JointPath long_path;
+  for ( int i = 0; i < 100000; ++i ) { long_path.points.push_back( { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }, 1.0 } ); }
+  DesignPatterns::ResponsibilityChain::ParallelChainValidator<DesignPatterns::ResponsibilityChain::JointCheckChain>
+      parallel( 4, 1024 );
+  if ( !parallel.check( long_path ) ) { return 1; }
+  long_path.points[ 90000 ].velocity = 0.0;
+  long_path.points[ 50000 ].joints.pop_back();
+  long_path.points[ 70000 ].velocity = -1.0;
+
+  // 多个块里都有错误点：反复校验，每次都只报告最小的下标及其错误
+  auto reportsFirst = [ &parallel, &long_path ]( size_t index, DesignPatterns::ResponsibilityChain::CheckError code ) {
+    DesignPatterns::ResponsibilityChain::DiagnosticRing found( 8 );
+    parallel.chain().setDiagnostics( &found );
+    bool ok = true;
+    for ( int round = 0; round < 20 && ok; ++round ) {
+      size_t reported = 0;
+      ok              = !parallel.check( long_path );
+      found.drain( [ & ]( const DesignPatterns::ResponsibilityChain::Diagnostic &d ) {
+        ok = ok && d.index == index && d.code == code;
+        ++reported;
+      } );
+      ok = ok && reported == 1;
+    }
+    parallel.chain().setDiagnostics( nullptr );
+    return ok;
+  };
+  using DesignPatterns::ResponsibilityChain::CheckError;
+  if ( !reportsFirst( 50000, CheckError::BadDimension ) ) { return 1; }
+  long_path.points[ 1500 ].velocity = 0.0;  // 第二个块
+  if ( !reportsFirst( 1500, CheckError::NonPositiveVelocity ) ) { return 1; }
+  long_path.points[ 1500 ].velocity = 1.0;
+  long_path.points[ 50000 ].joints.push_back( 0.0 );
+  if ( !reportsFirst( 70000, CheckError::NonPositiveVelocity ) ) { return 1; }
+  long_path.points[ 50000 ].joints.pop_back();
+  std::cout << "多个块同时出错时报告最小的出错下标" << std::endl;
+
+  // 工作线程常驻：多个线程同时调用 check() 时，拿不到工作线程的一方退回到串行检查，结果不变
+  DesignPatterns::ResponsibilityChain::JointPath clean_path;
+  clean_path.points.assign( 20000, { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }, 1.0 } );
+  std::atomic<int> wrong{ 0 };
+  {
+    std::vector<std::jthread> callers;
+    for ( int t = 0; t < 4; ++t ) {
+      callers.emplace_back( [ & ]() {
+        for ( int round = 0; round < 50; ++round ) {
+          if ( !parallel.check( clean_path ) ) { wrong.fetch_add( 1 ); }
+        }
+      } );
+    }
+  }
+  if ( wrong.load() != 0 ) { return 1; }
+  std::cout << "4 个线程并发调用 200 次，结果一致" << std::endl;
+
+  // 诊断写入预先分配的环形缓冲区，由使用者决定何时格式化输出
+  std::cout << "\n=== 结构化诊断 ===" << std::endl;
+  DesignPatterns::ResponsibilityChain::DiagnosticRing ring( 16 );
+  planner.setDiagnostics( &ring );
+  planner.validateJoint( long_path );
+  planner.validateJoint( DesignPatterns::ResponsibilityChain::JointPath{} );
+  parallel.chain().setDiagnostics( &ring );
+  parallel.check( long_path );
+
+  size_t drained = ring.drain( []( const DesignPatterns::ResponsibilityChain::Diagnostic &d ) {
+    std::cout << "取出诊断: " << d << " (value = " << d.value << ")" << std::endl;
+  } );
+  if ( drained != 3 ) { return 1; }
+
+  // 增量校验：追加或局部修改后只检查变化的部分（以及窗口校验需要回看的点）
+  std::cout << "\n=== 增量校验 ===" << std::endl;
+  using namespace DesignPatterns::ResponsibilityChain;
+  using StreamChain = CheckChain<JointLengthCheck, JointDimensionCheck, JointVelocityCheck,
+                                 JointVelocityContinuityCheck>;
+  JointPath live;
+  ValidationSession<StreamChain> session( live );
+  session.chain().get<JointVelocityContinuityCheck>().max_delta = 0.5;
+  session.chain().setDiagnostics( &ring );
+
+  for ( int segment = 0; segment < 3; ++segment ) {
+    for ( int i = 0; i < 100; ++i ) { live.points.push_back( { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }, 1.0 } ); }
+    if ( !session.validate() ) { return 1; }
+    std::cout << "追加后已校验 " << session.validated() << " 个点" << std::endl;
+  }
+
+  live.points[ 150 ].velocity = 2.0;  // 与前一个点的速度差过大
+  if ( session.edit( 150, 151 ) ) { return 1; }
+  live.points[ 150 ].velocity = 1.2;  // 与前后两点都在允许范围内
+  if ( !session.edit( 150, 151 ) ) { return 1; }
+  std::cout << "修改后已校验 " << session.validated() << " 个点" << std::endl;
+
+  ring.drain( []( const Diagnostic &d ) { std::cout << "取出诊断: " << d << std::endl; } );
+
+  return 0;
+}
+
+// 运行时链与编译期链的性能对比
+int bench_responsibility_chain()
+{
+  using namespace DesignPatterns::ResponsibilityChain;
+  std::cout << "=== 责任链性能对比 ===" << std::endl;
+
+  for ( size_t n : { size_t( 1000 ), size_t( 100000 ), size_t( 1000000 ) } ) {
+    JointPath path;
+    path.points.reserve( n );
+    for ( size_t i = 0; i < n; ++i ) {
+      double q = static_cast<double>( i % 100 ) * 0.01;
+      path.points.push_back( { { q, q, q, q, q, q }, 1.0 } );
+    }
+
+    const int repeat = static_cast<int>( 10000000 / n ) + 1;
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok    = true;
+    for ( int r = 0; r < repeat; ++r ) {
+      JointLengthCheck len;
+      JointDimensionCheck dim;
+      JointVelocityCheck vel;
+      len.next = &dim;
+      dim.next = &vel;
+      ok &= len.check( path );
+    }
+    auto runtime_ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+
+    JointCheckChain chain;
+    start = std::chrono::steady_clock::now();
+    for ( int r = 0; r < repeat; ++r ) { ok &= chain.check( path ); }
+    auto fused_ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+
+    if ( !ok ) { return 1; }
+    std::cout << n << " 个点: 运行时链 " << runtime_ns / repeat / n << " ns/点, 编译期链 " << fused_ns / repeat / n
+              << " ns/点" << std::endl;
+
+    // 并行分块校验，线程数从 1 翻倍到硬件线程数
+    const size_t hw = std::max( 1u, std::thread::hardware_concurrency() );
+    for ( size_t threads = 1; threads <= hw; threads *= 2 ) {
+      ParallelChainValidator<JointCheckChain> parallel( threads );
+      start = std::chrono::steady_clock::now();
+      for ( int r = 0; r < repeat; ++r ) { ok &= parallel.check( path ); }
+      auto parallel_ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+      std::cout << "    并行 " << threads << " 线程: " << parallel_ns / repeat / n << " ns/点" << std::endl;
+    }
+    if ( !ok ) { return 1; }
+  }
+
+  // 中等长度的路径：工作线程常驻，每次调用只是唤醒它们，而不是重新创建线程
+  JointPath medium;
+  for ( size_t i = 0; i < 16384; ++i ) { medium.points.push_back( { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 }, 1.0 } ); }
+  JointCheckChain serial;
+  ParallelChainValidator<JointCheckChain> pooled( 4 );
+  const int calls = 2000;
+  bool ok         = true;
+  auto start      = std::chrono::steady_clock::now();
+  for ( int r = 0; r < calls; ++r ) { ok &= serial.check( medium ); }
+  auto serial_us = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count();
+  start          = std::chrono::steady_clock::now();
+  for ( int r = 0; r < calls; ++r ) { ok &= pooled.check( medium ); }
+  auto pooled_us = std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count();
+  if ( !ok ) { return 1; }
+  std::cout << medium.points.size() << " 个点 (4 个块): 串行 " << serial_us / calls << " us/次, 并行 4 线程 "
+            << pooled_us / calls << " us/次" << std::endl;
   return 0;
 }
\ No newline at end of file
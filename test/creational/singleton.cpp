@@ -1,9 +1,39 @@
 #include "creational/singleton/singleton.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <vector>
 
+// 构造和析构时记录事件，用来检查服务的销毁顺序
+struct TracedService {
+  TracedService( std::string n, std::vector<std::string> &log ) : name( std::move( n ) ), events( log )
+  {
+    events.push_back( "+" + name );
+  }
+  ~TracedService() { events.push_back( "-" + name ); }
+
+  std::string name;
+  std::vector<std::string> &events;
+};
+
+struct TracedCounter {
+  std::atomic<int> hits{ 0 };
+};
+
 void worker_thread( int id )
 {
   auto &db = DesignPatterns::Singleton::Database::get_instance();
@@ -53,6 +83,612 @@ int test_singleton()
     if ( t.joinable() ) { t.join(); }
   }
 
+  // 4. RCU 配置：快照在持有期间不变，订阅者收到每个新版本
+  std::cout << "\n--- RCU Config Test ---" << std::endl;
+  db1.set_connection_string( "host=a" );
+  std::vector<uint64_t> seen;
+  size_t id = db1.subscribe_config( [ &seen ]( const auto &config, uint64_t version ) {
+    std::cout << "Config v" << version << ": " << config.connection_string << std::endl;
+    seen.push_back( version );
+  } );
+  uint64_t before = db1.config_version();
+  bool unchanged  = false;
+  std::thread writer;
+  {
+    auto snapshot = db1.config();
+    writer = std::thread( [ &db1 ]() { db1.set_connection_string( "host=b" ); } );  // 要等这个快照释放才能完成
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    unchanged = snapshot->connection_string == "host=a" && snapshot.version() == before;
+  }
+  writer.join();
+  if ( !unchanged || db1.get_connection_string() != "host=b" ) { return 1; }
+  db1.set_connection_string( "host=c" );
+  db1.unsubscribe_config( id );
+  db1.set_connection_string( "host=d" );
+  if ( seen != std::vector<uint64_t>{ before + 1, before + 2 } || db1.get_connection_string() != "host=d" ) {
+    return 1;
+  }
+
+  // 5. 连接池：上限、超时、线程亲和以及建立连接失败后重试
+  std::cout << "\n--- Connection Pool Test ---" << std::endl;
+  {
+    using namespace DesignPatterns::Singleton;
+    int failures = 1;
+    auto connect = [ &failures ]( size_t id ) -> std::unique_ptr<Connection> {
+      if ( failures-- > 0 ) { throw std::runtime_error( "backend unavailable" ); }
+      return std::make_unique<FakeConnection>( id, "fake://local" );
+    };
+    ConnectionPool pool( connect, PoolOptions{ 2, std::chrono::milliseconds( 10 ) } );
+    try {
+      pool.checkout();
+      return 1;
+    } catch ( const std::runtime_error &e ) {
+      std::cout << "First connect failed: " << e.what() << std::endl;
+    }
+    size_t first_id;
+    {
+      auto a = pool.checkout();
+      auto b = pool.checkout();
+      std::cout << a->execute( "SELECT 1" ) << ", " << b->execute( "SELECT 2" ) << std::endl;
+      if ( pool.try_checkout( std::chrono::milliseconds( 5 ) ) ) { return 1; }  // 已经达到上限
+      bool timed_out = false;
+      try {
+        pool.checkout();
+      } catch ( const PoolTimeout & ) {
+        timed_out = true;
+      }
+      if ( !timed_out ) { return 1; }
+      first_id = b.id();
+    }
+    if ( pool.checkout().id() != first_id ) { return 1; }  // 优先拿回本线程上次用过的连接
+
+    // 8 个线程争用 2 个连接；单核机器上持有连接的线程可能被调度出去很久，这里放宽超时
+    std::vector<std::thread> clients;
+    std::atomic<int> lost{ 0 };
+    for ( int t = 0; t < 8; ++t ) {
+      clients.emplace_back( [ &pool, &lost ]() {
+        for ( int i = 0; i < 1000; ++i ) {
+          if ( auto lease = pool.try_checkout( std::chrono::seconds( 10 ) ) ) {
+            ( *lease )->execute( "SELECT " + std::to_string( i ) );
+          } else {
+            lost.fetch_add( 1 );
+          }
+        }
+      } );
+    }
+    for ( auto &t : clients ) { t.join(); }
+    PoolStats stats = pool.stats();
+    std::cout << "checkouts " << stats.checkouts << ", timeouts " << stats.timeouts << ", created " << stats.created
+              << ", peak " << stats.peak_in_use << ", p50 " << stats.p50_ns << " ns, p99 " << stats.p99_ns << " ns"
+              << std::endl;
+    if ( stats.created != 2 || stats.peak_in_use != 2 || stats.in_use != 0 || stats.checkouts != 8003 ||
+         stats.timeouts != 2 || lost.load() != 0 ) {
+      return 1;
+    }
+  }
+  std::cout << db1.query( "SELECT now()" ) << std::endl;
+
+  // 6. 异步查询管线：规范化、合批、预备语句缓存
+  std::cout << "\n--- Query Pipeline Test ---" << std::endl;
+  {
+    using namespace DesignPatterns::Singleton;
+    std::vector<std::string> params;
+    std::string normalized = normalize_query( "SELECT  *\nFROM t1 WHERE id=42 AND name='O''Brien'", params );
+    std::cout << normalized << std::endl;
+    if ( normalized != "SELECT * FROM t1 WHERE id=? AND name=?" ||
+         params != std::vector<std::string>{ "42", "'O''Brien'" } ) {
+      return 1;
+    }
+
+    ConnectionPool pool( []( size_t id ) { return std::make_unique<FakeConnection>( id, "fake://local" ); },
+                         PoolOptions{ 2 } );
+    PipelineStats stats;
+    {
+      QueryPipeline pipeline( pool, PipelineOptions{ std::chrono::milliseconds( 5 ), 16, 2, 8 } );
+      std::vector<std::future<std::string>> results;
+      for ( int i = 0; i < 100; ++i ) {
+        results.push_back( pipeline.submit( "SELECT * FROM users WHERE id=" + std::to_string( i ) ) );
+      }
+      for ( int i = 0; i < 100; ++i ) {
+        std::string result = results[ i ].get();
+        if ( result.find( " OK: SELECT * FROM users WHERE id=" + std::to_string( i ) ) == std::string::npos ) {
+          return 1;
+        }
+      }
+      stats = pipeline.stats();
+    }
+    std::cout << "submitted " << stats.submitted << ", batches " << stats.batches << ", prepared " << stats.prepared
+              << ", cache hits " << stats.cache_hits << std::endl;
+    // 每批最多 16 条，同一形状的语句在每个连接上只准备一次
+    if ( stats.batches < 7 || stats.prepared > 2 || stats.prepared + stats.cache_hits != 100 ) { return 1; }
+
+    // 连接失败时 future 中带着异常
+    ConnectionPool broken( []( size_t ) -> std::unique_ptr<Connection> { throw std::runtime_error( "down" ); } );
+    QueryPipeline failing( broken );
+    auto failed = failing.submit( "SELECT 1" );
+    try {
+      failed.get();
+      return 1;
+    } catch ( const std::runtime_error &e ) {
+      std::cout << "Query failed: " << e.what() << std::endl;
+    }
+
+    std::cout << db1.submit( "SELECT * FROM users WHERE id=7" ).get() << std::endl;
+  }
+
+  // 7. 异步日志：多线程写入临时文件，缓冲区会多次回绕，还有一条超过缓冲区四分之一的记录
+  std::cout << "\n--- Async Logger Test ---" << std::endl;
+  {
+    using namespace DesignPatterns::Singleton;
+    const auto path = std::filesystem::temp_directory_path() / "singleton_logger_test.log";
+    const int fd    = ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ) { return 1; }
+    Logger &logger = Logger::get_instance();
+    logger.set_output( fd );
+    std::vector<std::thread> writers;
+    for ( int t = 0; t < 4; ++t ) {
+      writers.emplace_back( [ t ]() {
+        for ( int i = 0; i < 10000; ++i ) { log_info( "thread ", t, " line ", i, " ", std::string( "x" ) ); }
+      } );
+    }
+    for ( auto &w : writers ) { w.join(); }
+    log_info( "types: ", 2.5, " ", 1.0 / 3, " ", true, " ", 'c', " ", -7L, " ", static_cast<const void *>( nullptr ) );
+    log_debug( "compiled out" );
+    log_info( std::string( Logger::kBufferBytes / 2, 'y' ) );
+    logger.set_output( STDOUT_FILENO );
+    ::close( fd );
+
+    std::ifstream in( path );
+    std::map<int, int> next_line;  // 每个线程的行必须按顺序出现
+    std::string line, types;
+    size_t lines = 0, long_line = 0, types_at = 0, long_at = 0;
+    while ( std::getline( in, line ) ) {
+      ++lines;
+      int thread, index;
+      if ( std::sscanf( line.c_str(), "thread %d line %d x", &thread, &index ) == 2 ) {
+        if ( next_line[ thread ]++ != index ) { return 1; }
+      } else if ( line.starts_with( "types: " ) ) {
+        types    = line;
+        types_at = lines;
+      } else {
+        long_line = line.size();
+        long_at   = lines;
+      }
+    }
+    std::filesystem::remove( path );
+    std::cout << lines << " lines, " << types << ", stalls " << logger.stalls() << std::endl;
+    // 超长的记录绕过缓冲区直接写出，但不能跑到同一线程之前的记录前面
+    if ( lines != 40002 || types != "types: 2.5 0.333333 1 c -7 0" || long_line != Logger::kBufferBytes / 2 ||
+         long_at < types_at ) {
+      return 1;
+    }
+  }
+
+  // 8. 服务注册表：按名字区分同类型的服务、依赖先构造后销毁、循环依赖、并发首次访问只构造一次
+  std::cout << "\n--- Service Registry Test ---" << std::endl;
+  {
+    using namespace DesignPatterns::Singleton;
+    std::vector<std::string> events;
+    {
+      ServiceRegistry registry;
+      registry.add<TracedService>( "primary", [ &events ]( ServiceRegistry & ) {
+        return std::make_unique<TracedService>( "primary", events );
+      } );
+      registry.add<TracedService>( "replica", [ &events ]( ServiceRegistry &r ) {
+        r.get<TracedService>( "primary" );  // 副本依赖主库
+        return std::make_unique<TracedService>( "replica", events );
+      } );
+      if ( registry.add<TracedService>( "primary", nullptr ) || registry.constructed() != 0 ) { return 1; }
+      TracedService &replica = registry.get<TracedService>( "replica" );
+      if ( &replica != &registry.get<TracedService>( "replica" ) || replica.name != "replica" ) { return 1; }
+
+      registry.add<TracedService>( "cycle", []( ServiceRegistry &r ) {
+        r.get<TracedService>( "cycle" );
+        return std::unique_ptr<TracedService>();
+      } );
+      bool cycle = false, missing = false;
+      try {
+        registry.get<TracedService>( "cycle" );
+      } catch ( const std::logic_error & ) {
+        cycle = true;
+      }
+      try {
+        registry.get<TracedService>( "unknown" );
+      } catch ( const ServiceNotFound & ) {
+        missing = true;
+      }
+      std::cout << "cycle detected: " << cycle << ", missing service reported: " << missing << std::endl;
+      if ( !cycle || !missing ) { return 1; }
+
+      // 注册足够多的服务，让每个分片的表扩容几次
+      for ( int i = 0; i < 500; ++i ) {
+        registry.add<int>( "counter-" + std::to_string( i ), [ i ]( ServiceRegistry & ) {
+          return std::make_unique<int>( i );
+        } );
+      }
+      std::atomic<int> mismatches{ 0 };
+      std::vector<std::thread> threads;
+      for ( int t = 0; t < 8; ++t ) {
+        threads.emplace_back( [ &registry, &mismatches, t ]() {
+          for ( int i = 0; i < 500; ++i ) {
+            const int k = ( i + t * 61 ) % 500;
+            if ( registry.get<int>( "counter-" + std::to_string( k ) ) != k ) { ++mismatches; }
+          }
+        } );
+      }
+      for ( auto &t : threads ) { t.join(); }
+      std::cout << registry.size() << " services registered, " << registry.constructed() << " constructed"
+                << std::endl;
+      if ( mismatches != 0 || registry.size() != 503 || registry.constructed() != 502 ) { return 1; }
+    }
+    for ( const auto &e : events ) { std::cout << e << " "; }
+    std::cout << std::endl;
+    if ( events != std::vector<std::string>{ "+primary", "+replica", "-replica", "-primary" } ) { return 1; }
+
+    // 工厂返回空指针时抛出异常，不记为已构造；shutdown() 之后再 get 会重新构造
+    {
+      ServiceRegistry registry;
+      registry.add<TracedCounter>( "null", []( ServiceRegistry & ) { return std::unique_ptr<TracedCounter>(); } );
+      registry.add<TracedService>( "again", [ &events ]( ServiceRegistry & ) {
+        return std::make_unique<TracedService>( "again", events );
+      } );
+      bool rejected = false;
+      try {
+        registry.get<TracedCounter>( "null" );
+      } catch ( const std::runtime_error & ) {
+        rejected = true;
+      }
+      events.clear();
+      registry.get<TracedService>( "again" );
+      registry.shutdown();
+      const size_t after_shutdown = registry.constructed();
+      TracedService &again        = registry.get<TracedService>( "again" );
+      std::cout << "null factory rejected: " << rejected << ", constructed after shutdown " << after_shutdown
+                << ", after get " << registry.constructed() << std::endl;
+      if ( !rejected || after_shutdown != 0 || registry.constructed() != 1 || again.name != "again" ||
+           events != std::vector<std::string>{ "+again", "-again", "+again" } ) {
+        return 1;
+      }
+    }
+
+    // 两个线程从环的两端同时进入：a 依赖 b、b 依赖 a，两个工厂都先等对方开始构造，不能死锁
+    {
+      ServiceRegistry registry;
+      std::atomic<int> entered{ 0 };
+      auto factory = [ &entered ]( const char *dependency ) {
+        return [ &entered, dependency ]( ServiceRegistry &r ) {
+          entered.fetch_add( 1 );
+          while ( entered.load() < 2 ) { std::this_thread::yield(); }
+          r.get<TracedCounter>( dependency );
+          return std::make_unique<TracedCounter>();
+        };
+      };
+      registry.add<TracedCounter>( "a", factory( "b" ) );
+      registry.add<TracedCounter>( "b", factory( "a" ) );
+      std::atomic<int> cycles{ 0 };
+      std::vector<std::thread> threads;
+      for ( const char *name : { "a", "b" } ) {
+        threads.emplace_back( [ &registry, &cycles, name ]() {
+          try {
+            registry.get<TracedCounter>( name );
+          } catch ( const std::logic_error & ) {
+            cycles.fetch_add( 1 );
+          }
+        } );
+      }
+      for ( auto &t : threads ) { t.join(); }
+      std::cout << "cross-thread cycle reported by " << cycles << " threads" << std::endl;
+      if ( cycles != 2 || registry.constructed() != 0 ) { return 1; }
+    }
+
+    // 通用单例：未注册的可默认构造类型自动注册，所有线程拿到同一个对象
+    std::vector<const TracedCounter *> seen( 4 );
+    std::vector<std::thread> threads;
+    for ( int t = 0; t < 4; ++t ) {
+      threads.emplace_back( [ &seen, t ]() {
+        for ( int i = 0; i < 1000; ++i ) { Singleton<TracedCounter>::get().hits.fetch_add( 1 ); }
+        seen[ t ] = &Singleton<TracedCounter>::get();
+      } );
+    }
+    for ( auto &t : threads ) { t.join(); }
+    const TracedCounter &counter = ServiceRegistry::global().get<TracedCounter>();
+    std::cout << "Singleton<TracedCounter> hits: " << counter.hits << std::endl;
+    if ( counter.hits != 4000 || std::count( seen.begin(), seen.end(), &counter ) != 4 ) { return 1; }
+
+    // 全局注册表 shutdown() 之后，线程局部的缓存失效，再访问得到重新构造的对象
+    Singleton<TracedCounter>::get().hits.fetch_add( 1 );
+    ServiceRegistry::global().shutdown();
+    TracedCounter &rebuilt = Singleton<TracedCounter>::get();
+    std::cout << "after global shutdown: hits " << rebuilt.hits << std::endl;
+    if ( rebuilt.hits != 0 || &rebuilt != &ServiceRegistry::global().get<TracedCounter>() ) { return 1; }
+  }
+
   std::cout << "--- Singleton Test End ---" << std::endl;
   return 0;
 }
+
+// 原来的实现：每次读取都加锁并复制字符串
+class MutexConfig
+{
+ public:
+  void set_connection_string( const std::string &conn_str )
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    connection_string_ = conn_str;
+  }
+
+  std::string get_connection_string() const
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return connection_string_;
+  }
+
+ private:
+  std::string connection_string_;
+  mutable std::mutex mutex_;
+};
+
+// 64 个读者线程各读取 reads 次，2 个写者每毫秒发布一次新配置，返回每次读取的平均耗时 (ns)
+template <typename Read, typename Write>
+double run_config_bench( Read read, Write write, int reads )
+{
+  const int readers = 64;
+  std::atomic<bool> done{ false };
+  std::atomic<size_t> checksum{ 0 };  // 让读取的结果被使用，避免被优化掉
+  std::vector<std::thread> writers;
+  for ( int w = 0; w < 2; ++w ) {
+    writers.emplace_back( [ &, w ]() {
+      for ( int i = 0; !done.load(); ++i ) {
+        write( "postgresql://db-" + std::to_string( w ) + ".internal:5432/app?version=" + std::to_string( i ) );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      }
+    } );
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for ( int r = 0; r < readers; ++r ) {
+    threads.emplace_back( [ &, reads ]() {
+      size_t sum = 0;
+      for ( int i = 0; i < reads; ++i ) { sum += read(); }
+      checksum.fetch_add( sum );
+    } );
+  }
+  for ( auto &t : threads ) { t.join(); }
+  double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+  done.store( true );
+  for ( auto &t : writers ) { t.join(); }
+  return ns / ( static_cast<double>( readers ) * reads );
+}
+
+// 单例访问的三种方式，都禁止内联，循环里每次访问都真正执行一遍
+struct BenchService {
+  std::atomic<uint64_t> value{ 1 };
+};
+
+[[gnu::noinline]] BenchService &meyers_service()
+{
+  static BenchService instance;  // 每次调用检查一次守卫变量
+  return instance;
+}
+
+[[gnu::noinline]] BenchService &registry_service()
+{
+  return DesignPatterns::Singleton::ServiceRegistry::global().get<BenchService>( "bench" );
+}
+
+[[gnu::noinline]] BenchService &cached_service()
+{
+  return DesignPatterns::Singleton::Singleton<BenchService>::get();
+}
+
+// threads 个线程各访问 per_thread 次，返回每次访问的平均耗时 (ns)
+template <typename Access>
+double run_access_bench( Access access, int threads, int per_thread )
+{
+  std::atomic<uint64_t> checksum{ 0 };
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for ( int t = 0; t < threads; ++t ) {
+    workers.emplace_back( [ &access, &checksum, per_thread ]() {
+      uint64_t sum = 0;
+      for ( int i = 0; i < per_thread; ++i ) { sum += access().value.load( std::memory_order_relaxed ); }
+      checksum.fetch_add( sum );
+    } );
+  }
+  for ( auto &w : workers ) { w.join(); }
+  const double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+  return checksum.load() == static_cast<uint64_t>( threads ) * per_thread ? ns / ( threads * per_thread ) : -1;
+}
+
+int bench_singleton()
+{
+  auto &db    = DesignPatterns::Singleton::Database::get_instance();
+  const int n = 200000;
+
+  MutexConfig locked;
+  locked.set_connection_string( "postgresql://db-0.internal:5432/app?version=0" );
+  double mutex_ns = run_config_bench( [ &locked ]() { return locked.get_connection_string().size(); },
+                                      [ &locked ]( const std::string &s ) { locked.set_connection_string( s ); }, n );
+
+  db.set_connection_string( "postgresql://db-0.internal:5432/app?version=0" );
+  auto write         = [ &db ]( const std::string &s ) { db.set_connection_string( s ); };
+  uint64_t before    = db.config_version();
+  double view_ns     = run_config_bench( [ &db ]() { return db.get_connection_string().size(); }, write, n );
+  double copy_ns =
+      run_config_bench( [ &db ]() { return std::string( db.get_connection_string() ).size(); }, write, n );
+  double snapshot_ns = run_config_bench( [ &db ]() { return db.config()->connection_string.size(); }, write, n );
+
+  std::cout << "64 个读者, 2 个写者每毫秒发布一次, 每次读取平均: mutex + 复制 " << mutex_ns
+            << " ns, get_connection_string " << view_ns << " ns, RCU + 复制 " << copy_ns << " ns, RCU 快照 "
+            << snapshot_ns << " ns (期间发布了 " << db.config_version() - before << " 个版本)" << std::endl;
+
+  // 所有查询经过同一个连接（加锁） 与 连接池；每条查询在假后端上占用 2 us
+  using namespace DesignPatterns::Singleton;
+  const FakeBackendCosts costs{ .execute = std::chrono::microseconds( 2 ) };
+  const int queries  = 20000;
+  for ( int clients : { 1, 2, 4, 8 } ) {
+    auto run = [ clients ]( auto &&query ) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for ( int t = 0; t < clients; ++t ) {
+        threads.emplace_back( [ &query, clients ]() {
+          for ( int i = 0; i < queries / clients; ++i ) { query( i ); }
+        } );
+      }
+      for ( auto &t : threads ) { t.join(); }
+      return queries / std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    };
+
+    FakeConnection shared( 0, "fake://local", costs );
+    std::mutex shared_mutex;
+    double single_qps = run( [ & ]( int i ) {
+      std::lock_guard<std::mutex> lock( shared_mutex );
+      shared.execute( "SELECT " + std::to_string( i ) );
+    } );
+
+    auto connect = [ costs ]( size_t id ) { return std::make_unique<FakeConnection>( id, "fake://local", costs ); };
+    ConnectionPool pool( connect, PoolOptions{ 8, std::chrono::milliseconds( 10000 ) } );
+    double pool_qps = run( [ &pool ]( int i ) { pool.checkout()->execute( "SELECT " + std::to_string( i ) ); } );
+    PoolStats stats = pool.stats();
+    std::cout << clients << " 个客户端: 单个连接 " << single_qps / 1e3 << " K qps, 连接池 " << pool_qps / 1e3
+              << " K qps (借出 p50 " << stats.p50_ns << " ns, p99 " << stats.p99_ns << " ns, 建立 " << stats.created
+              << " 个连接, 峰值 " << stats.peak_in_use << ", 利用率 " << stats.utilization * 100 << "%)" << std::endl;
+  }
+
+  // 同步查询 与 异步管线：往返 100 us，解析 5 us，执行 1 us；16 个客户端，8 个连接
+  {
+    const FakeBackendCosts backend{ std::chrono::microseconds( 100 ), std::chrono::microseconds( 5 ),
+                                    std::chrono::microseconds( 1 ) };
+    auto connect = [ backend ]( size_t id ) { return std::make_unique<FakeConnection>( id, "fake://local", backend ); };
+    const int clients = 16, per_client = 2000;
+    auto sql          = []( int i ) {
+      return "SELECT * FROM orders WHERE customer=" + std::to_string( i ) + " AND status=" + std::to_string( i % 3 );
+    };
+    // 每个客户端的延迟 (ns) 汇总后给出 qps、p50、p99
+    auto report = []( const char *name, std::vector<std::vector<uint64_t>> &latencies, double seconds ) {
+      std::vector<uint64_t> all;
+      for ( auto &l : latencies ) { all.insert( all.end(), l.begin(), l.end() ); }
+      std::sort( all.begin(), all.end() );
+      std::cout << name << ": " << all.size() / seconds / 1e3 << " K qps, p50 " << all[ all.size() / 2 ] / 1e3
+                << " us, p99 " << all[ all.size() * 99 / 100 ] / 1e3 << " us" << std::endl;
+    };
+    auto now_ns = []() {
+      return static_cast<uint64_t>( std::chrono::steady_clock::now().time_since_epoch().count() );
+    };
+
+    ConnectionPool sync_pool( connect, PoolOptions{ 8, std::chrono::milliseconds( 10000 ) } );
+    std::vector<std::vector<uint64_t>> latencies( clients );
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for ( int c = 0; c < clients; ++c ) {
+      threads.emplace_back( [ &, c ]() {
+        for ( int i = 0; i < per_client; ++i ) {
+          const uint64_t begin = now_ns();
+          sync_pool.checkout()->execute( sql( i ) );
+          latencies[ c ].push_back( now_ns() - begin );
+        }
+      } );
+    }
+    for ( auto &t : threads ) { t.join(); }
+    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    report( "同步 execute", latencies, seconds );
+
+    // 每个客户端最多同时有 window 条查询在途
+    for ( int window : { 1, 64 } ) {
+      ConnectionPool async_pool( connect, PoolOptions{ 8, std::chrono::milliseconds( 10000 ) } );
+      QueryPipeline pipeline( async_pool, PipelineOptions{ std::chrono::microseconds( 200 ), 64, 8, 256 } );
+      for ( auto &l : latencies ) { l.clear(); }
+      threads.clear();
+      start = std::chrono::steady_clock::now();
+      for ( int c = 0; c < clients; ++c ) {
+        threads.emplace_back( [ &, c, window ]() {
+          std::vector<std::pair<uint64_t, std::future<std::string>>> in_flight;
+          for ( int i = 0; i < per_client; i += window ) {
+            for ( int j = i; j < std::min( i + window, per_client ); ++j ) {
+              in_flight.emplace_back( now_ns(), pipeline.submit( sql( j ) ) );
+            }
+            for ( auto &[ begin, result ] : in_flight ) {
+              result.get();
+              latencies[ c ].push_back( now_ns() - begin );
+            }
+            in_flight.clear();
+          }
+        } );
+      }
+      for ( auto &t : threads ) { t.join(); }
+      seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      report( window == 1 ? "QueryPipeline, 每个客户端 1 条在途" : "QueryPipeline, 每个客户端 64 条在途", latencies,
+              seconds );
+      PipelineStats stats = pipeline.stats();
+      std::cout << "  " << stats.batches << " 批, 平均每批 " << static_cast<double>( stats.submitted ) / stats.batches
+                << " 条, prepare " << stats.prepared << " 次, 缓存命中 " << stats.cache_hits << " 次" << std::endl;
+    }
+  }
+
+  // 日志：std::cout + std::endl 与异步日志，都写到 /dev/null；异步日志分别统计调用耗时和全部写出的耗时
+  {
+    const int lines = 1000000;
+    const std::string name( "renderer" );
+    for ( int threads : { 1, 4 } ) {
+      auto run = [ threads ]( auto &&log_line ) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for ( int t = 0; t < threads; ++t ) {
+          workers.emplace_back( [ &log_line, threads ]() {
+            for ( int i = 0; i < lines / threads; ++i ) { log_line( i ); }
+          } );
+        }
+        for ( auto &w : workers ) { w.join(); }
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count() / lines;
+      };
+
+      std::ofstream null_stream( "/dev/null" );
+      auto *old_buf = std::cout.rdbuf( null_stream.rdbuf() );
+      std::mutex cout_mutex;  // 多个线程同时写 std::cout 时行会交错，这里和日志一样按行加锁
+      double cout_ns = run( [ & ]( int i ) {
+        std::lock_guard<std::mutex> lock( cout_mutex );
+        std::cout << "[" << name << "] Drawing circle pixels, radius=" << i * 0.5f << ", frame " << i << std::endl;
+      } );
+      std::cout.rdbuf( old_buf );
+
+      auto &logger  = Logger::get_instance();
+      const int fd  = ::open( "/dev/null", O_WRONLY );
+      const int old = logger.output();
+      logger.set_output( fd );
+      const uint64_t stalls = logger.stalls();
+      auto start            = std::chrono::steady_clock::now();
+      double log_ns         = run( [ & ]( int i ) {
+        log_info( "[", name, "] Drawing circle pixels, radius=", i * 0.5f, ", frame ", i );
+      } );
+      logger.flush();
+      double total_ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+      logger.set_output( old );
+      ::close( fd );
+      std::cout << threads << " 个线程各写 " << lines / threads << " 行: std::cout + endl " << cout_ns
+                << " ns/行, 异步日志调用 " << log_ns << " ns/行, 包括格式化和写出 " << total_ns / lines
+                << " ns/行 (缓冲区写满等待 " << logger.stalls() - stalls << " 次)" << std::endl;
+    }
+  }
+
+  // 单例访问：static 局部变量、注册表按名字查找、Singleton<T> 的线程局部缓存
+  {
+    using DesignPatterns::Singleton::ServiceRegistry;
+    ServiceRegistry::global().add<BenchService>( "bench", []( ServiceRegistry & ) {
+      return std::make_unique<BenchService>();
+    } );
+    for ( int i = 0; i < 200; ++i ) {  // 让注册表里有足够多的其他服务
+      ServiceRegistry::global().add<int>( "filler-" + std::to_string( i ), [ i ]( ServiceRegistry & ) {
+        return std::make_unique<int>( i );
+      } );
+    }
+    const int accesses = 20000000;
+    for ( int threads : { 1, 4, 16 } ) {
+      const int per_thread = accesses / threads;
+      std::cout << threads << " 个线程: static 局部变量 " << run_access_bench( meyers_service, threads, per_thread )
+                << " ns/次, 注册表查找 " << run_access_bench( registry_service, threads, per_thread / 10 )
+                << " ns/次, Singleton<T> " << run_access_bench( cached_service, threads, per_thread ) << " ns/次"
+                << std::endl;
+    }
+  }
+  return 0;
+}
@@ -7,14 +7,19 @@ int test_builder();
 int test_factory();
 int test_prototype();
 int test_singleton();
+int bench_singleton();
 int test_adapter();
 int test_bridge();
 int test_composite();
+int bench_composite();
 int test_facade();
 int test_flyweight();
+int bench_flyweight();
 int test_proxy();
 int test_responsibility_chain();
+int bench_responsibility_chain();
 int test_command();
+int bench_command();
 
 int main( int argc, char *argv[] )
 {
@@ -25,14 +30,19 @@ int main( int argc, char *argv[] )
               << "  factory\n"
               << "  prototype\n"
               << "  singleton\n"
+              << "  singleton_bench\n"
               << "  adapter\n"
               << "  bridge\n"
               << "  composite\n"
+              << "  composite_bench\n"
               << "  facade\n"
               << "  flyweight\n"
+              << "  flyweight_bench\n"
               << "  proxy\n"
               << "  responsibility_chain\n"
-              << "  command" << std::endl;
+              << "  responsibility_chain_bench\n"
+              << "  command\n"
+              << "  command_bench" << std::endl;
     return 1;
   }
 
@@ -43,14 +53,19 @@ int main( int argc, char *argv[] )
   if ( test_name == "factory" ) { return test_factory(); }
   if ( test_name == "prototype" ) { return test_prototype(); }
   if ( test_name == "singleton" ) { return test_singleton(); }
+  if ( test_name == "singleton_bench" ) { return bench_singleton(); }
   if ( test_name == "adapter" ) { return test_adapter(); }
   if ( test_name == "bridge" ) { return test_bridge(); }
   if ( test_name == "composite" ) { return test_composite(); }
+  if ( test_name == "composite_bench" ) { return bench_composite(); }
   if ( test_name == "facade" ) { return test_facade(); }
   if ( test_name == "flyweight" ) { return test_flyweight(); }
+  if ( test_name == "flyweight_bench" ) { return bench_flyweight(); }
   if ( test_name == "proxy" ) { return test_proxy(); }
   if ( test_name == "responsibility_chain" ) { return test_responsibility_chain(); }
+  if ( test_name == "responsibility_chain_bench" ) { return bench_responsibility_chain(); }
   if ( test_name == "command" ) { return test_command(); }
+  if ( test_name == "command_bench" ) { return bench_command(); }
 
   std::cerr << "Error: Unknown test '" << test_name << "'" << std::endl;
   return 1;
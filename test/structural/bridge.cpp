@@ -20,11 +20,13 @@ int test_bridge()
   circle->draw();
 
   // 4. 动态改变实现 (如果我们要演示桥接的灵活性：可以在运行时换实现 - 这里我们新建一个对象演示)
+  DesignPatterns::Singleton::log_flush();  // 渲染日志是异步写出的，先写完再输出下一段标题
   std::cout << "\n--- Switching Implementation: Circle with Raster Renderer ---" << std::endl;
   auto circle_raster = std::make_shared<Circle>( raster_renderer, 5.0f );
   circle_raster->draw();
 
   // 5. 改变抽象部分的属性，不影响实现部分
+  DesignPatterns::Singleton::log_flush();
   std::cout << "\n--- Resizing Circle ---" << std::endl;
   circle_raster->resize( 2.0f );  // 半径变为 10.0
   circle_raster->draw();
@@ -1,6 +1,23 @@
 #include "structural/composite/composite.h"
+#include "structural/composite/flat_composite.h"
+#include "structural/composite/parallel_reduce.h"
+#include "structural/composite/fs_scanner.h"
+#include "structural/composite/tree_writer.h"
+#include "structural/composite/tree_diff.h"
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <string>
 
 int test_composite()
 {
@@ -28,5 +45,490 @@ int test_composite()
 
   std::cout << "\nTotal Size of Root: " << dir_root->get_size() << " KB" << std::endl;
 
+  // 扁平组合树：同样的结构存放在一个 arena 中，目录大小随添加增量维护
+  std::cout << "\n=== Flat Composite ===" << std::endl;
+  FlatFileSystem fs( "Root" );
+  NodeId docs = fs.add_directory( FlatFileSystem::root(), "Documents" );
+  fs.add_file( docs, "resume.pdf", 200 );
+  NodeId notes = fs.add_file( docs, "notes.txt", 10 );
+  fs.add_file( FlatFileSystem::root(), "photo.png", 500 );
+  auto flat_root = fs.view( FlatFileSystem::root() );
+  flat_root->print();
+  std::cout << "Total Size of Root: " << flat_root->get_size() << " KB" << std::endl;
+  if ( flat_root->get_size() != dir_root->get_size() ) { return 1; }
+
+  // 通过 FileSystemNode 接口添加：指针树的子树和 arena 自身的子树都会被复制进来
+  flat_root->add( dir_docs );
+  fs.view( docs )->add( fs.view( docs ) );
+  fs.set_file_size( notes, 30 );
+  flat_root->print();
+  std::cout << "Total Size of Root: " << flat_root->get_size() << " KB" << std::endl;
+  if ( fs.get_size( docs ) != 230 + 210 || flat_root->get_size() != 440 + 500 + 210 ) { return 1; }
+  try {
+    fs.view( notes )->add( file1 );
+    return 1;
+  } catch ( const std::runtime_error &e ) {
+    std::cout << "Expected error: " << e.what() << std::endl;
+  }
+
+  // 并行归约：结果与串行递归一致，拼接字符串也保持原来的顺序
+  std::cout << "\n=== Parallel Reduce ===" << std::endl;
+  ForkJoinPool pool( 4 );
+  ReduceOptions fine{ 1, 10 };  // 小树也强制拆分
+  auto listing = parallel_reduce(
+      pool, *dir_root, std::string(),
+      []( const FileSystemNode &n, int depth ) { return std::string( depth * 2, ' ' ) + n.get_name() + "\n"; },
+      []( std::string a, std::string b ) { return a + b; }, fine );
+  std::cout << listing;
+  std::cout << "size " << parallel_total_size( pool, *dir_root, fine ) << ", nodes "
+            << parallel_node_count( pool, *dir_root, fine ) << ", depth " << parallel_max_depth( pool, *dir_root, fine )
+            << std::endl;
+  if ( listing != "Root\n  Documents\n    resume.pdf\n    notes.txt\n  photo.png\n" ||
+       parallel_total_size( pool, *dir_root, fine ) != dir_root->get_size() ||
+       parallel_node_count( pool, *dir_root, fine ) != 5 || parallel_max_depth( pool, *dir_root, fine ) != 2 ) {
+    return 1;
+  }
+  // arena 视图通过 children() 暴露子节点，同样可以并行归约
+  std::cout << "flat size " << parallel_total_size( pool, *flat_root, fine ) << ", nodes "
+            << parallel_node_count( pool, *flat_root, fine ) << std::endl;
+  if ( parallel_total_size( pool, *flat_root, fine ) != fs.get_size( FlatFileSystem::root() ) ||
+       parallel_node_count( pool, *flat_root, fine ) != fs.node_count() ) {
+    return 1;
+  }
+
+  // 流式输出：文本格式与 print() 完全一致，JSON / NDJSON 供其他程序读取
+  std::cout << "\n=== Tree Writer ===" << std::endl;
+  std::ostringstream printed, written;
+  auto *old_buf = std::cout.rdbuf( printed.rdbuf() );
+  dir_root->print();
+  std::cout.rdbuf( old_buf );
+  {
+    TreeWriter writer( written, 64 );  // 很小的缓冲区，覆盖多次 flush 的情况
+    writer.write( *dir_root, TreeFormat::Text );
+  }
+  if ( written.str() != printed.str() ) { return 1; }
+  {  // arena 视图按指针树的方式写出，与 arena 自身的 print() 一致
+    std::ostringstream view_printed, view_written;
+    old_buf = std::cout.rdbuf( view_printed.rdbuf() );
+    fs.print( FlatFileSystem::root() );
+    std::cout.rdbuf( old_buf );
+    TreeWriter writer( view_written );
+    writer.write( *flat_root, TreeFormat::Text );
+    writer.flush();
+    if ( view_written.str() != view_printed.str() ) { return 1; }
+  }
+  std::ostringstream json, ndjson, flat_json;
+  {
+    TreeWriter writer( json );
+    writer.write( *dir_root, TreeFormat::Json );
+    TreeWriter nd( ndjson );
+    nd.write( *dir_root, TreeFormat::Ndjson );
+    TreeWriter flat( flat_json );
+    FlatFileSystem small( "Root" );
+    small.add_file( small.add_directory( FlatFileSystem::root(), "A \"quoted\" dir" ), "x", 7 );
+    flat.write( small, FlatFileSystem::root(), TreeFormat::Json );
+  }
+  std::cout << json.str() << ndjson.str() << flat_json.str();
+  if ( json.str() != "{\"name\":\"Root\",\"type\":\"directory\",\"children\":["
+                     "{\"name\":\"Documents\",\"type\":\"directory\",\"children\":["
+                     "{\"name\":\"resume.pdf\",\"type\":\"file\",\"size\":200},"
+                     "{\"name\":\"notes.txt\",\"type\":\"file\",\"size\":10}],\"size\":210},"
+                     "{\"name\":\"photo.png\",\"type\":\"file\",\"size\":500}],\"size\":710}\n" ||
+       ndjson.str().find( "{\"path\":\"Root/Documents/notes.txt\",\"type\":\"file\",\"depth\":2,\"size\":10}\n" ) ==
+           std::string::npos ||
+       flat_json.str().find( "\"A \\\"quoted\\\" dir\"" ) == std::string::npos ) {
+    return 1;
+  }
+
+  // 子树哈希与比较：只进入哈希不同的目录
+  std::cout << "\n=== Tree Diff ===" << std::endl;
+  auto snapshot = [ & ]() {
+    auto root = std::make_shared<Directory>( "Root" );
+    auto docs = std::make_shared<Directory>( "Documents" );
+    docs->add( std::make_shared<File>( "resume.pdf", 200 ) );
+    docs->add( std::make_shared<File>( "notes.txt", 10 ) );
+    root->add( docs );
+    root->add( std::make_shared<File>( "photo.png", 500 ) );
+    return root;
+  };
+  auto before = snapshot(), after = snapshot();
+  if ( before->content_hash() != after->content_hash() || !diff_trees( *before, *after ).empty() ) { return 1; }
+  auto after_docs = std::static_pointer_cast<Directory>( after->children()[ 0 ] );
+  std::static_pointer_cast<File>( after_docs->children()[ 1 ] )->set_size( 12 );  // notes.txt
+  after_docs->add( std::make_shared<File>( "todo.md", 1 ) );
+  after->remove( "photo.png" );
+  auto changes = diff_trees( *before, *after );
+  const char *kinds[] = { "Added", "Removed", "Modified" };
+  for ( const auto &c : changes ) { std::cout << kinds[ static_cast<int>( c.kind ) ] << " " << c.path << std::endl; }
+  if ( changes.size() != 3 || changes[ 0 ].path != "Documents/notes.txt" || changes[ 1 ].path != "Documents/todo.md" ||
+       changes[ 2 ].kind != TreeChange::Kind::Removed ) {
+    return 1;
+  }
+  // 改回原样后哈希也恢复，与子节点顺序无关
+  std::static_pointer_cast<File>( after_docs->children()[ 1 ] )->set_size( 10 );
+  after_docs->remove( "todo.md" );
+  after->add( std::make_shared<File>( "photo.png", 500 ) );
+  if ( before->content_hash() != after->content_hash() ) { return 1; }
+
+  // 把已经属于某个目录的节点加到别处：从原目录移出，原目录的哈希随之改变
+  auto moved = after_docs->children()[ 0 ];  // resume.pdf
+  after->add( moved );
+  if ( after_docs->children().size() != 1 || moved->get_parent() != after.get() ||
+       after_docs->content_hash() == std::static_pointer_cast<Directory>( before->children()[ 0 ] )->content_hash() ) {
+    return 1;
+  }
+  try {
+    after_docs->add( after );
+    return 1;
+  } catch ( const std::runtime_error &e ) {
+    std::cout << "Expected error: " << e.what() << std::endl;
+  }
+
+  // 子节点比目录活得久：目录销毁后子节点不再指向它，修改大小、再挂到别处都是安全的
+  auto orphan = std::make_shared<File>( "orphan.txt", 1 );
+  {
+    auto temp = std::make_shared<Directory>( "temp" );
+    temp->add( orphan );
+    temp->content_hash();  // 缓存哈希，之后修改大小会沿 parent 往上标记
+  }
+  orphan->set_size( 2 );
+  after->add( orphan );
+  if ( orphan->get_parent() != after.get() || after->children().back() != orphan ) { return 1; }
+  after->remove( "orphan.txt" );
+
+  // arena 与指针树使用相同的哈希；修改 arena 后重新比较能看到变化
+  FlatFileSystem arena( "Root" );
+  NodeId arena_docs = arena.add_directory( FlatFileSystem::root(), "Documents" );
+  arena.add_file( arena_docs, "resume.pdf", 200 );
+  NodeId arena_notes = arena.add_file( arena_docs, "notes.txt", 10 );
+  arena.add_file( FlatFileSystem::root(), "photo.png", 500 );
+  auto arena_root = arena.view( FlatFileSystem::root() );
+  if ( arena_root->content_hash() != before->content_hash() || !diff_trees( *before, *arena_root ).empty() ) {
+    return 1;
+  }
+  arena.set_file_size( arena_notes, 12 );
+  arena.add_file( arena_docs, "todo.md", 1 );
+  changes = diff_trees( *before, *arena_root );
+  for ( const auto &c : changes ) { std::cout << kinds[ static_cast<int>( c.kind ) ] << " " << c.path << std::endl; }
+  if ( changes.size() != 2 || changes[ 0 ].path != "Documents/notes.txt" ||
+       changes[ 0 ].kind != TreeChange::Kind::Modified || changes[ 1 ].path != "Documents/todo.md" ) {
+    return 1;
+  }
+  // 名字和总大小相同、内容不同的 arena 目录哈希不同
+  FlatFileSystem left( "Root" ), right( "Root" );
+  left.add_file( left.add_directory( FlatFileSystem::root(), "d" ), "a", 5 );
+  right.add_file( right.add_directory( FlatFileSystem::root(), "d" ), "b", 5 );
+  if ( left.content_hash( FlatFileSystem::root() ) == right.content_hash( FlatFileSystem::root() ) ||
+       diff_trees( *left.view( FlatFileSystem::root() ), *right.view( FlatFileSystem::root() ) ).size() != 2 ) {
+    return 1;
+  }
+  // arena 视图不能挂到指针树的目录下，否则 arena 变化后目录的哈希不会失效
+  try {
+    after->add( left.view( FlatFileSystem::root() ) );
+    return 1;
+  } catch ( const std::runtime_error &e ) {
+    std::cout << "Expected error: " << e.what() << std::endl;
+  }
+
+  // 扫描磁盘上的目录：硬链接只计一次大小，指向祖先目录的符号链接不会造成死循环
+  std::cout << "\n=== FileSystem Scanner ===" << std::endl;
+  namespace stdfs = std::filesystem;
+  const stdfs::path scan_root = stdfs::temp_directory_path() / "composite_scan_test";
+  stdfs::remove_all( scan_root );
+  stdfs::create_directories( scan_root / "docs" / "deep" );
+  std::ofstream( scan_root / "docs" / "a.txt" ) << std::string( 3000, 'a' );
+  std::ofstream( scan_root / "docs" / "deep" / "b.txt" ) << "b";
+  stdfs::create_hard_link( scan_root / "docs" / "a.txt", scan_root / "a_link.txt" );
+  stdfs::create_directory_symlink( scan_root, scan_root / "docs" / "deep" / "loop" );
+
+  FileSystemScanner scanner( ScanOptions{ 4, true } );
+  auto scanned = scanner.scan( scan_root );
+  scanned->print();
+  const ScanStats &stats = scanner.stats();
+  std::cout << "files " << stats.files << ", directories " << stats.directories << ", hardlinks " << stats.hardlinks
+            << ", loops " << stats.loops << ", size " << scanned->get_size() << " KB" << std::endl;
+  stdfs::remove_all( scan_root );
+  if ( stats.files != 3 || stats.directories != 3 || stats.hardlinks != 1 || stats.loops != 1 ||
+       scanned->get_size() != 3 + 1 ) {
+    return 1;
+  }
+
+  // 完整路径远超 PATH_MAX 的深层目录：只能相对父目录逐层创建和删除
+  const int depth           = 300;
+  const std::string segment = "level_directory_";
+  stdfs::create_directories( scan_root );
+  std::vector<int> fds{ ::open( scan_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC ) };
+  for ( int i = 0; i < depth && fds.back() >= 0; ++i ) {
+    ::mkdirat( fds.back(), segment.c_str(), 0755 );
+    fds.push_back( ::openat( fds.back(), segment.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC ) );
+  }
+  if ( fds.back() < 0 ) { return 1; }
+  const int leaf = ::openat( fds.back(), "leaf.txt", O_WRONLY | O_CREAT | O_CLOEXEC, 0644 );
+  if ( leaf < 0 || ::write( leaf, "x", 1 ) != 1 ) { return 1; }
+  ::close( leaf );
+
+  FileSystemScanner deep_scanner( ScanOptions{ 4, false } );
+  auto deep                   = deep_scanner.scan( scan_root );
+  const ScanStats &deep_stats = deep_scanner.stats();
+  std::cout << "depth " << depth << " (" << depth * ( segment.size() + 1 ) << " byte path): files "
+            << deep_stats.files << ", directories " << deep_stats.directories << ", errors " << deep_stats.errors
+            << std::endl;
+
+  ::unlinkat( fds.back(), "leaf.txt", 0 );
+  for ( size_t i = fds.size() - 1; i > 0; --i ) {
+    ::close( fds[ i ] );
+    ::unlinkat( fds[ i - 1 ], segment.c_str(), AT_REMOVEDIR );
+  }
+  ::close( fds[ 0 ] );
+  stdfs::remove_all( scan_root );
+  if ( deep_stats.files != 1 || deep_stats.directories != depth + 1 || deep_stats.errors != 0 ||
+       deep->get_size() != 1 ) {
+    return 1;
+  }
+
+  // 文件描述符上限很低：待读的子目录持有的父目录描述符会耗尽上限，放弃它们后按路径重新打开，不计为错误
+  for ( const char *branch : { "a", "b", "c" } ) {
+    for ( const char *leaf : { "x", "y" } ) {
+      stdfs::create_directories( scan_root / branch / leaf );
+      std::ofstream( scan_root / branch / leaf / "f.txt" ) << "f";
+    }
+  }
+  const int lowest_free = ::dup( 0 );
+  ::close( lowest_free );
+  struct rlimit saved_limit{};
+  ::getrlimit( RLIMIT_NOFILE, &saved_limit );
+  struct rlimit low_limit = saved_limit;
+  low_limit.rlim_cur      = static_cast<rlim_t>( lowest_free + 2 );
+  if ( ::setrlimit( RLIMIT_NOFILE, &low_limit ) != 0 ) { return 1; }
+  FileSystemScanner limited_scanner( ScanOptions{ 1, false } );
+  auto limited = limited_scanner.scan( scan_root );
+  ::setrlimit( RLIMIT_NOFILE, &saved_limit );
+  const ScanStats &limited_stats = limited_scanner.stats();
+  std::cout << "fd limit " << low_limit.rlim_cur << ": files " << limited_stats.files << ", directories "
+            << limited_stats.directories << ", errors " << limited_stats.errors << ", fd limit hits "
+            << limited_stats.fd_limit_hits << std::endl;
+  stdfs::remove_all( scan_root );
+  if ( limited_stats.files != 6 || limited_stats.directories != 10 || limited_stats.errors != 0 ||
+       limited_stats.fd_limit_hits == 0 || limited->get_size() != 6 ) {
+    return 1;
+  }
+  return 0;
+}
+
+namespace
+{
+
+size_t heapBytes() { return mallinfo2().uordblks; }
+
+double secondsSince( std::chrono::steady_clock::time_point start )
+{
+  return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+}  // namespace
+
+// 每个目录有 fanout 个子目录，最底层目录下各有 files 个文件
+std::shared_ptr<DesignPatterns::Composite::Directory> makeTree( int fanout, int depth, int files,
+                                                               const std::string &name = "root" )
+{
+  using namespace DesignPatterns::Composite;
+  auto dir = std::make_shared<Directory>( name );
+  if ( depth == 0 ) {
+    for ( int f = 0; f < files; ++f ) {
+      dir->add( std::make_shared<File>( "f" + std::to_string( f ), f % 1000 + 1 ) );
+    }
+  } else {
+    for ( int c = 0; c < fanout; ++c ) { dir->add( makeTree( fanout, depth - 1, files, "d" + std::to_string( c ) ) ); }
+  }
+  return dir;
+}
+
+int bench_composite()
+{
+  using namespace DesignPatterns::Composite;
+
+  // 扫描磁盘目录：std::filesystem::recursive_directory_iterator 串行构建 与 FileSystemScanner
+  {
+    namespace stdfs = std::filesystem;
+    const auto root = stdfs::temp_directory_path() / "composite_scan_bench";
+    const int dirs  = 500;
+    const int files = 200;
+    if ( !stdfs::exists( root / ".complete" ) ) {  // 测试数据只生成一次，留给后续运行复用
+      stdfs::remove_all( root );
+      for ( int d = 0; d < dirs; ++d ) {
+        const auto dir = root / std::to_string( d / 50 ) / std::to_string( d );
+        stdfs::create_directories( dir );
+        for ( int f = 0; f < files; ++f ) { std::ofstream( dir / std::to_string( f ) ) << f; }
+      }
+      std::ofstream( root / ".complete" );
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto base  = std::make_shared<Directory>( root.filename().string() );
+    std::vector<std::pair<stdfs::path, std::shared_ptr<Directory>>> open_dirs{ { root, base } };
+    size_t base_files = 0;
+    for ( auto it = stdfs::recursive_directory_iterator( root ); it != stdfs::recursive_directory_iterator(); ++it ) {
+      open_dirs.resize( static_cast<size_t>( it.depth() ) + 1 );
+      const auto &parent = open_dirs.back().second;
+      if ( it->is_directory() ) {
+        auto dir = std::make_shared<Directory>( it->path().filename().string() );
+        parent->add( dir );
+        open_dirs.emplace_back( it->path(), dir );
+      } else {
+        parent->add( std::make_shared<File>( it->path().filename().string(),
+                                             static_cast<int>( ( it->file_size() + 1023 ) / 1024 ) ) );
+        ++base_files;
+      }
+    }
+    double serial = secondsSince( start );
+
+    const size_t threads = std::max( 1u, std::thread::hardware_concurrency() );
+    FileSystemScanner scanner( ScanOptions{ threads, false } );
+    start           = std::chrono::steady_clock::now();
+    auto scanned    = scanner.scan( root );
+    double parallel = secondsSince( start );
+    std::cout << "扫描 " << scanner.stats().files << " 个文件, " << scanner.stats().directories
+              << " 个目录: recursive_directory_iterator " << serial * 1e3 << " ms, FileSystemScanner (" << threads
+              << " 线程) " << parallel * 1e3 << " ms" << std::endl;
+    if ( scanner.stats().files != base_files || scanned->get_size() != base->get_size() ) { return 1; }
+  }
+
+  // 输出约一百万个节点的树：print() 逐行 std::endl 与 TreeWriter 缓冲输出，都写到 /dev/null
+  {
+    auto root = makeTree( 10, 5, 10 );
+    std::ofstream null_stream( "/dev/null" );
+    auto *old_buf = std::cout.rdbuf( null_stream.rdbuf() );
+    auto start    = std::chrono::steady_clock::now();
+    root->print();
+    double print = secondsSince( start );
+    std::cout.rdbuf( old_buf );
+
+    const int fd = ::open( "/dev/null", O_WRONLY );
+    double text = 0, json = 0;
+    size_t bytes = 0;
+    {
+      auto writer = TreeWriter::to_fd( fd );
+      start       = std::chrono::steady_clock::now();
+      writer.write( *root, TreeFormat::Text );
+      writer.flush();
+      text  = secondsSince( start );
+      start = std::chrono::steady_clock::now();
+      writer.write( *root, TreeFormat::Json );
+      writer.flush();
+      json  = secondsSince( start );
+      bytes = writer.bytes_written();
+    }
+    ::close( fd );
+    std::cout << "输出 1111111 个节点: print() " << print * 1e3 << " ms, TreeWriter 文本 " << text * 1e3
+              << " ms, JSON " << json * 1e3 << " ms (" << bytes / ( 1 << 20 ) << " MB)" << std::endl;
+  }
+
+  // 两棵一千一百万个节点、只有几处不同的树：完整遍历 与 按哈希跳过相同子树的比较
+  {
+    auto before = makeTree( 10, 6, 10 );
+    auto after  = makeTree( 10, 6, 10 );
+    auto start  = std::chrono::steady_clock::now();
+    before->content_hash();
+    after->content_hash();
+    double first_hash = secondsSince( start );
+
+    // 沿第 i 条路径往下走到底层目录，修改其中一个文件并添加一个文件
+    for ( int i = 0; i < 10; ++i ) {
+      FileSystemNode *dir = after.get();
+      for ( int level = 0; level < 6; ++level ) { dir = dir->children()[ ( i * 7 + level ) % 10 ].get(); }
+      static_cast<File *>( dir->children()[ i ].get() )->set_size( 100000 + i );
+      dir->add( std::make_shared<File>( "new" + std::to_string( i ), 1 ) );
+    }
+    start             = std::chrono::steady_clock::now();
+    long long walked  = before->get_size() + after->get_size();
+    double full_walk  = secondsSince( start );
+    start             = std::chrono::steady_clock::now();
+    auto changes      = diff_trees( *before, *after );
+    double diff       = secondsSince( start );
+    std::cout << "比较两棵 11111111 个节点的树: 首次计算哈希 " << first_hash * 1e3 << " ms, 完整遍历一次 "
+              << full_walk * 1e3 << " ms, diff_trees " << diff * 1e3 << " ms (" << changes.size() << " 处变化, 总大小 "
+              << walked << ")" << std::endl;
+    if ( changes.size() != 20 ) { return 1; }
+  }
+
+  // 不同形状的树：串行递归 get_size 与 fork-join 并行归约
+  {
+    const size_t threads = std::max( 1u, std::thread::hardware_concurrency() );
+    ForkJoinPool pool( threads );
+    struct Shape {
+      const char *name;
+      int fanout, depth, files;
+    };
+    for ( const Shape &shape : { Shape{ "二叉深树", 2, 18, 4 }, Shape{ "十叉树", 10, 5, 10 },
+                                 Shape{ "宽目录", 1, 0, 2000000 }, Shape{ "千叉浅树", 1000, 1, 1000 } } ) {
+      auto root      = makeTree( shape.fanout, shape.depth, shape.files );
+      auto start     = std::chrono::steady_clock::now();
+      long long size = root->get_size();
+      double serial  = secondsSince( start );
+      start          = std::chrono::steady_clock::now();
+      long long psize = parallel_total_size( pool, *root );
+      double parallel = secondsSince( start );
+      std::cout << shape.name << " (" << parallel_node_count( pool, *root ) << " 个节点, 深度 "
+                << parallel_max_depth( pool, *root ) << "): 串行 " << serial * 1e3 << " ms, 并行 (" << threads
+                << " 线程) " << parallel * 1e3 << " ms" << std::endl;
+      if ( size != psize ) { return 1; }
+    }
+  }
+
+  // 约一千万个节点：1000 个目录 × 100 个子目录 × 99 个文件
+  constexpr int kTop = 1000, kSub = 100, kFiles = 99;
+  long long expected = 0;
+  {
+    size_t before = heapBytes();
+    auto start    = std::chrono::steady_clock::now();
+    auto root     = std::make_shared<Directory>( "root" );
+    for ( int a = 0; a < kTop; ++a ) {
+      auto top = std::make_shared<Directory>( "d" + std::to_string( a ) );
+      for ( int b = 0; b < kSub; ++b ) {
+        auto sub = std::make_shared<Directory>( "s" + std::to_string( b ) );
+        for ( int f = 0; f < kFiles; ++f ) {
+          sub->add( std::make_shared<File>( "f" + std::to_string( f ), f + 1 ) );
+          expected += f + 1;
+        }
+        top->add( sub );
+      }
+      root->add( top );
+    }
+    double build = secondsSince( start );
+    size_t bytes = heapBytes() - before;
+    start        = std::chrono::steady_clock::now();
+    int size     = root->get_size();
+    double query = secondsSince( start );
+    std::cout << "Directory:      build " << build * 1e3 << " ms, " << bytes / ( 1 << 20 ) << " MB, get_size "
+              << query * 1e3 << " ms (" << size << ")" << std::endl;
+    if ( size != expected ) { return 1; }
+  }
+  {
+    size_t before = heapBytes();
+    auto start    = std::chrono::steady_clock::now();
+    FlatFileSystem fs( "root" );
+    fs.reserve( 1 + kTop + kTop * kSub + size_t( kTop ) * kSub * kFiles, size_t( kTop ) * kSub * kFiles * 3 );
+    for ( int a = 0; a < kTop; ++a ) {
+      NodeId top = fs.add_directory( FlatFileSystem::root(), "d" + std::to_string( a ) );
+      for ( int b = 0; b < kSub; ++b ) {
+        NodeId sub = fs.add_directory( top, "s" + std::to_string( b ) );
+        for ( int f = 0; f < kFiles; ++f ) { fs.add_file( sub, "f" + std::to_string( f ), f + 1 ); }
+      }
+    }
+    double build = secondsSince( start );
+    size_t bytes = heapBytes() - before;
+    start        = std::chrono::steady_clock::now();
+    auto size    = fs.get_size( FlatFileSystem::root() );
+    double query = secondsSince( start );
+    start        = std::chrono::steady_clock::now();
+    long long walked = 0;
+    fs.walk( FlatFileSystem::root(), [ &fs, &walked ]( NodeId id, int ) {
+      if ( !fs.is_directory( id ) ) { walked += fs.get_size( id ); }
+    } );
+    double walk = secondsSince( start );
+    std::cout << "FlatFileSystem: build " << build * 1e3 << " ms, " << bytes / ( 1 << 20 ) << " MB, get_size "
+              << query * 1e3 << " ms (" << size << "), 遍历 " << walk * 1e3 << " ms" << std::endl;
+    if ( size != expected || walked != expected ) { return 1; }
+  }
   return 0;
 }
@@ -1,5 +1,22 @@
 #include "structural/flyweight/flyweight.h"
+#include "structural/flyweight/compact_forest.h"
+#include "structural/flyweight/forest_grid.h"
+#include "structural/flyweight/forest_snapshot.h"
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 int test_flyweight()
 {
@@ -19,5 +36,351 @@ int test_flyweight()
   forest.plantTree( 85, 100, "松树", "深绿" );  // 重复类型
 
   forest.render();
+  DesignPatterns::Singleton::log_flush();  // 渲染日志是异步写出的，先写完再输出下一段标题
+
+  // 多个线程同时向工厂请求同一批类型，每种类型只会创建一次
+  std::cout << "\n=== 并发获取享元 ===" << std::endl;
+  std::vector<std::thread> loaders;
+  for ( int t = 0; t < 4; ++t ) {
+    loaders.emplace_back( [ &treeFactory ]() {
+      for ( int i = 0; i < 1000; ++i ) { treeFactory->getTree( i % 2 ? "橡树" : "柳树", "绿色" ); }
+    } );
+  }
+  for ( auto &t : loaders ) { t.join(); }
+  DesignPatterns::Singleton::log_flush();
+  std::cout << "树的类型数: " << treeFactory->getTreeTypesCount() << std::endl;
+  if ( treeFactory->getTreeTypesCount() != 5 ) { return 1; }
+
+  // 紧凑森林：与上面的森林共享同一个工厂，每棵树只保存坐标和 32 位句柄
+  DesignPatterns::Flyweight::CompactForest compact( treeFactory );
+  compact.plantTree( 10, 20, "橡树", "绿色" );
+  compact.plantTree( 15, 30, "松树", "深绿" );
+  compact.plantTree( 25, 40, "橡树", "绿色" );
+  compact.render();
+  DesignPatterns::Singleton::log_flush();
+  std::cout << "每棵树 " << DesignPatterns::Flyweight::CompactForest::kBytesPerTree << " 字节" << std::endl;
+  if ( compact.typeColumn()[ 0 ] != compact.typeColumn()[ 2 ] ) { return 1; }
+
+  // 空间索引：只渲染视口内的树，同一种树合成一个批次
+  compact.plantTree( 300, 300, "枫树", "红色" );
+  DesignPatterns::Flyweight::ForestGrid grid( compact, 16 );
+  grid.render( { 0, 0, 30, 45 } );
+  size_t visible = 0;
+  grid.query( { 0, 0, 30, 45 }, [ &visible ]( size_t ) { ++visible; } );
+  size_t batches = 0;
+  grid.forEachBatch( { 0, 0, 30, 45 }, [ &batches ]( const auto &, const auto & ) { ++batches; } );
+  if ( visible != 3 || batches != 2 ) { return 1; }
+  size_t outside = 0;
+  grid.query( { -100, -100, -1, -1 }, [ &outside ]( size_t ) { ++outside; } );
+  if ( outside != 0 ) { return 1; }
+  {  // 坐标跨越整个 int 范围时格子下标的计算不能溢出
+    DesignPatterns::Flyweight::CompactForest extremes( treeFactory );
+    constexpr int lo = std::numeric_limits<int>::min(), hi = std::numeric_limits<int>::max();
+    extremes.plantTree( lo, lo, "橡树", "绿色" );
+    extremes.plantTree( hi, hi, "松树", "深绿" );
+    extremes.plantTree( 0, 0, "橡树", "绿色" );
+    DesignPatterns::Flyweight::ForestGrid wide( extremes, 16 );
+    size_t found = 0, corner = 0;
+    wide.query( { lo, lo, hi, hi }, [ &found ]( size_t ) { ++found; } );
+    wide.query( { hi - 1, hi - 1, hi, hi }, [ &corner ]( size_t ) { ++corner; } );
+    if ( found != 3 || corner != 1 ) { return 1; }
+  }
+
+  // 二进制快照：保存后用另一个工厂零拷贝打开
+  const auto snapshot_path = std::filesystem::temp_directory_path() / "flyweight_forest.snap";
+  DesignPatterns::Flyweight::ForestSnapshot::save( compact, snapshot_path );
+  {
+    auto snapshot = DesignPatterns::Flyweight::ForestSnapshot::open(
+        snapshot_path, std::make_shared<DesignPatterns::Flyweight::TreeFactory>() );
+    snapshot.render();
+    auto copy = snapshot.toCompactForest();
+    if ( snapshot.size() != compact.size() || copy.xColumn() != compact.xColumn() ||
+         snapshot.tree( snapshot.handleColumn()[ 3 ] ).getType() != "枫树" ) {
+      return 1;
+    }
+  }
+  // 工厂创建树时抛出异常：open 把异常传出来，映射同样被解除
+  {
+    auto mappings = [ &snapshot_path ]() {
+      std::ifstream maps( "/proc/self/maps" );
+      size_t count = 0;
+      for ( std::string line; std::getline( maps, line ); ) {
+        if ( line.find( snapshot_path.filename().string() ) != std::string::npos ) { ++count; }
+      }
+      return count;
+    };
+    auto throwing = std::make_shared<DesignPatterns::Flyweight::TreeFactory>(
+        nullptr, []( const std::string &type, const std::string & ) -> std::string {
+          throw std::runtime_error( "模型文件缺失: " + type );
+        } );
+    bool thrown = false;
+    try {
+      DesignPatterns::Flyweight::ForestSnapshot::open( snapshot_path, throwing );
+    } catch ( const std::runtime_error & ) {
+      thrown = true;
+    }
+    if ( !thrown || mappings() != 0 ) { return 1; }
+  }
+  // 损坏的快照：越界的句柄在访问时报错，过大的实例数量在打开时报错，都不会越界读取
+  {
+    std::string bytes;
+    {
+      std::ifstream in( snapshot_path, std::ios::binary );
+      bytes.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+    }
+    DesignPatterns::Flyweight::detail::SnapshotHeader header;
+    std::memcpy( &header, bytes.data(), sizeof( header ) );
+    auto reopen = [ & ]() {
+      std::ofstream( snapshot_path, std::ios::binary | std::ios::trunc ) << bytes;
+      return DesignPatterns::Flyweight::ForestSnapshot::open(
+          snapshot_path, std::make_shared<DesignPatterns::Flyweight::TreeFactory>() );
+    };
+    const uint32_t bad_handle = 1000;
+    std::memcpy( bytes.data() + header.handles_offset + sizeof( uint32_t ), &bad_handle, sizeof( bad_handle ) );
+    auto corrupt = reopen();
+    int rejected = 0;
+    try {
+      corrupt.forEach( []( const DesignPatterns::Flyweight::Tree &, int, int ) {} );
+    } catch ( const std::runtime_error & ) {
+      ++rejected;
+    }
+    try {
+      corrupt.toCompactForest();
+    } catch ( const std::runtime_error & ) {
+      ++rejected;
+    }
+    header.tree_count = uint64_t( 1 ) << 62;  // n * sizeof( int ) 会溢出
+    std::memcpy( bytes.data(), &header, sizeof( header ) );
+    try {
+      reopen();
+    } catch ( const std::runtime_error &e ) {
+      std::cout << "Expected error: " << e.what() << std::endl;
+      ++rejected;
+    }
+    if ( rejected != 3 ) { return 1; }
+  }
+  std::filesystem::remove( snapshot_path );
+
+  // 后台加载模型：getTree 立即返回，并发请求同一种树只加载一次
+  DesignPatterns::Singleton::log_flush();
+  std::cout << "\n=== 异步加载模型 ===" << std::endl;
+  std::atomic<int> loads{ 0 };
+  auto asyncFactory = std::make_shared<DesignPatterns::Flyweight::TreeFactory>(
+      std::make_shared<DesignPatterns::Flyweight::ModelLoader>( 2 ),
+      [ &loads ]( const std::string &type, const std::string &color ) {
+        ++loads;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+        return DesignPatterns::Flyweight::Tree::loadModel( type, color );
+      } );
+  std::vector<std::thread> requesters;
+  for ( int t = 0; t < 4; ++t ) {
+    requesters.emplace_back( [ &asyncFactory ]() { asyncFactory->getTree( "银杏", "金黄" ); } );
+  }
+  for ( auto &t : requesters ) { t.join(); }
+  auto ginkgo = asyncFactory->getTree( "银杏", "金黄" );
+  ginkgo->render( 5, 5 );  // 模型还没加载完，使用占位模型
+  ginkgo->waitLoaded();
+  ginkgo->render( 5, 5 );
+  if ( !ginkgo->isLoaded() || loads.load() != 1 ) { return 1; }
+
+  // 加载失败：渲染继续使用占位模型，getModel() 重新抛出加载时的异常
+  DesignPatterns::Flyweight::TreeFactory failingFactory(
+      std::make_shared<DesignPatterns::Flyweight::ModelLoader>( 1 ),
+      []( const std::string &type, const std::string & ) -> std::string {
+        throw std::runtime_error( "模型文件缺失: " + type );
+      } );
+  auto broken = failingFactory.getTree( "枯树", "灰" );
+  broken->waitLoaded();
+  broken->render( 6, 6 );
+  bool rethrown = false;
+  try {
+    broken->getModel();
+  } catch ( const std::runtime_error & ) {
+    rethrown = true;
+  }
+  if ( !broken->isLoaded() || broken->getModelOrPlaceholder() != DesignPatterns::Flyweight::Tree::kPlaceholderModel ||
+       !rethrown ) {
+    return 1;
+  }
+  return 0;
+}
+
+// 原来基于 std::map 的工厂，加锁后才能被多个线程使用，作为基准测试的对照
+class MapTreeFactory
+{
+ public:
+  std::shared_ptr<DesignPatterns::Flyweight::Tree> getTree( const std::string &type, const std::string &color )
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    std::string key = type + "_" + color;
+    if ( trees.find( key ) != trees.end() ) { return trees[ key ]; }
+    auto newTree = std::make_shared<DesignPatterns::Flyweight::Tree>( type, color );
+    trees[ key ] = newTree;
+    return newTree;
+  }
+
+ private:
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<DesignPatterns::Flyweight::Tree>> trees;
+};
+
+template <typename Factory>
+double lookupsPerSecond( Factory &factory, const std::vector<std::string> &types,
+                         const std::vector<std::string> &colors, int threads, size_t lookups )
+{
+  std::vector<std::thread> workers;
+  std::atomic<size_t> sink{ 0 };
+  auto start = std::chrono::steady_clock::now();
+  for ( int t = 0; t < threads; ++t ) {
+    workers.emplace_back( [ &, t ]() {
+      size_t local = 0;
+      for ( size_t i = 0; i < lookups; ++i ) {
+        const size_t k = ( i * 7 + t ) % ( types.size() * colors.size() );
+        local += factory.getTree( types[ k % types.size() ], colors[ k / types.size() ] )->getType().size();
+      }
+      sink += local;
+    } );
+  }
+  for ( auto &w : workers ) { w.join(); }
+  double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  return sink.load() ? static_cast<double>( lookups ) * threads / seconds : 0.0;
+}
+
+int bench_flyweight()
+{
+  std::vector<std::string> types, colors;
+  for ( int i = 0; i < 8; ++i ) {
+    types.push_back( "tree_type_" + std::to_string( i ) );
+    colors.push_back( "color_" + std::to_string( i ) );
+  }
+
+  MapTreeFactory mapFactory;
+  DesignPatterns::Flyweight::TreeFactory poolFactory;
+  const size_t lookups = 1000000;
+  lookupsPerSecond( mapFactory, types, colors, 1, 64 );  // 预先创建所有类型
+  lookupsPerSecond( poolFactory, types, colors, 1, 64 );
+
+  for ( int threads : { 1, 8, 32 } ) {
+    double map_rate  = lookupsPerSecond( mapFactory, types, colors, threads, lookups / threads );
+    double pool_rate = lookupsPerSecond( poolFactory, types, colors, threads, lookups / threads );
+    std::cout << threads << " 线程: std::map + mutex " << map_rate / 1e6 << " M 次/秒, InternPool "
+              << pool_rate / 1e6 << " M 次/秒" << std::endl;
+  }
+
+  // 一次出现 64 种新树，每种模型加载 2 ms：同步加载 与 后台加载下 getTree 的最长耗时
+  {
+    auto slowLoad = []( const std::string &type, const std::string &color ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+      return DesignPatterns::Flyweight::Tree::loadModel( type, color );
+    };
+    DesignPatterns::Flyweight::TreeFactory syncFactory( nullptr, slowLoad );
+    DesignPatterns::Flyweight::TreeFactory asyncFactory( std::make_shared<DesignPatterns::Flyweight::ModelLoader>( 4 ),
+                                                         slowLoad );
+    auto worstLatency = [ & ]( DesignPatterns::Flyweight::TreeFactory &f ) {
+      double worst = 0;
+      for ( int i = 0; i < 64; ++i ) {
+        auto start = std::chrono::steady_clock::now();
+        f.getTree( "new_type_" + std::to_string( i ), colors[ 0 ] );
+        worst = std::max( worst, std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count() );
+      }
+      return worst;
+    };
+    double sync_worst  = worstLatency( syncFactory );
+    double async_worst = worstLatency( asyncFactory );
+    std::cout << "64 种新树: 同步加载 getTree 最长 " << sync_worst * 1e3 << " ms, 后台加载 " << async_worst * 1e3
+              << " ms" << std::endl;
+  }
+
+  // 一千万棵树：shared_ptr 对 与 SoA 紧凑布局
+  auto factory       = std::make_shared<DesignPatterns::Flyweight::TreeFactory>();
+  const size_t n     = 10000000;
+  auto seconds_since = []( std::chrono::steady_clock::time_point start ) {
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  };
+  std::vector<DesignPatterns::Flyweight::TreeHandle> handles;
+  for ( const auto &type : types ) { handles.push_back( factory->getHandle( type, colors[ 0 ] ) ); }
+
+  {
+    DesignPatterns::Flyweight::Forest forest( factory );
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < n; ++i ) {
+      forest.plantTree( static_cast<int>( i ), static_cast<int>( i >> 8 ), types[ i % types.size() ], colors[ 0 ] );
+    }
+    double plant  = seconds_since( start );
+    start         = std::chrono::steady_clock::now();
+    long long sum = 0;
+    forest.forEach( [ &sum ]( const DesignPatterns::Flyweight::Tree &, int x, int y ) { sum += x + y; } );
+    double iterate = seconds_since( start );
+    std::cout << "Forest:        "
+              << sizeof( std::pair<std::shared_ptr<DesignPatterns::Flyweight::Tree>, std::pair<int, int>> )
+              << " 字节/棵, 种树 " << n / plant / 1e6 << " M 棵/秒, 遍历 " << n / iterate / 1e6 << " M 棵/秒 ("
+              << sum % 10 << ")" << std::endl;
+  }
+  {
+    // 与 Forest 一样按 (类型, 颜色) 字符串种树，种树速度才可以直接比较
+    DesignPatterns::Flyweight::CompactForest forest( factory );
+    auto start = std::chrono::steady_clock::now();
+    for ( size_t i = 0; i < n; ++i ) {
+      forest.plantTree( static_cast<int>( i ), static_cast<int>( i >> 8 ), types[ i % types.size() ], colors[ 0 ] );
+    }
+    double plant  = seconds_since( start );
+    start         = std::chrono::steady_clock::now();
+    long long sum = 0;
+    forest.forEach( [ &sum ]( const DesignPatterns::Flyweight::Tree &, int x, int y ) { sum += x + y; } );
+    double iterate = seconds_since( start );
+    std::cout << "CompactForest: " << DesignPatterns::Flyweight::CompactForest::kBytesPerTree << " 字节/棵, 种树 "
+              << n / plant / 1e6 << " M 棵/秒, 遍历 " << n / iterate / 1e6 << " M 棵/秒 (" << sum % 10 << ")"
+              << std::endl;
+
+    // 调用方预先解析好句柄时省掉每棵树的字符串查找
+    {
+      DesignPatterns::Flyweight::CompactForest by_handle( factory );
+      start = std::chrono::steady_clock::now();
+      for ( size_t i = 0; i < n; ++i ) {
+        by_handle.plantTree( static_cast<int>( i ), static_cast<int>( i >> 8 ), handles[ i % handles.size() ] );
+      }
+      std::cout << "CompactForest (预先解析句柄): 种树 " << n / seconds_since( start ) / 1e6 << " M 棵/秒" << std::endl;
+    }
+
+    // 视口约占整片森林的 1%：全量扫描逐棵判断 与 网格索引
+    DesignPatterns::Flyweight::ForestGrid grid( forest );
+    const DesignPatterns::Flyweight::Viewport view{ static_cast<int>( n / 2 ), 0, static_cast<int>( n / 2 + n / 100 ),
+                                                    static_cast<int>( n >> 8 ) };
+    start        = std::chrono::steady_clock::now();
+    size_t count = 0;
+    const auto &xs = forest.xColumn();
+    const auto &ys = forest.yColumn();
+    for ( size_t i = 0; i < forest.size(); ++i ) {
+      count += xs[ i ] >= view.min_x && xs[ i ] <= view.max_x && ys[ i ] >= view.min_y && ys[ i ] <= view.max_y;
+    }
+    double scan = seconds_since( start );
+    start       = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    grid.query( view, [ &hits ]( size_t ) { ++hits; } );
+    double indexed = seconds_since( start );
+    std::cout << "视口查询 (" << hits << " 棵可见): 全量扫描 " << scan * 1e3 << " ms, ForestGrid " << indexed * 1e3
+              << " ms" << ( count == hits ? "" : " (结果不一致)" ) << std::endl;
+    if ( count != hits ) { return 1; }
+
+    // 快照：保存后零拷贝打开 与 逐棵 plantTree 重建
+    const auto path = std::filesystem::temp_directory_path() / "flyweight_bench.snap";
+    start           = std::chrono::steady_clock::now();
+    DesignPatterns::Flyweight::ForestSnapshot::save( forest, path );
+    double save = seconds_since( start );
+    start       = std::chrono::steady_clock::now();
+    auto snapshot = DesignPatterns::Flyweight::ForestSnapshot::open(
+        path, std::make_shared<DesignPatterns::Flyweight::TreeFactory>() );
+    double open = seconds_since( start );
+    start = std::chrono::steady_clock::now();
+    DesignPatterns::Flyweight::CompactForest rebuilt( std::make_shared<DesignPatterns::Flyweight::TreeFactory>() );
+    snapshot.forEach( [ &rebuilt ]( const DesignPatterns::Flyweight::Tree &tree, int x, int y ) {
+      rebuilt.plantTree( x, y, tree.getType(), tree.getColor() );
+    } );
+    double rebuild = seconds_since( start );
+    std::cout << "快照 (" << std::filesystem::file_size( path ) / ( 1 << 20 ) << " MB): 保存 " << save * 1e3
+              << " ms, 打开 " << open * 1e3 << " ms, 逐棵 plantTree 重建 " << rebuild * 1e3 << " ms" << std::endl;
+    if ( rebuilt.size() != snapshot.size() ) { return 1; }
+    std::filesystem::remove( path );
+  }
   return 0;
 }
\ No newline at end of file
@@ -18,5 +18,7 @@ int test_proxy()
   monitor.temperature = 85.0;  // 会触发高温警告
   monitor.displayStatus();
 
+  // 温度日志是异步写出的，退出前写完
+  DesignPatterns::Singleton::log_flush();
   return 0;
 }
\ No newline at end of file